@@ -0,0 +1,625 @@
+// Benchmarks de host dos estágios de processamento do firmware.
+//
+//   hcsr04_bench distance   conversão pulso -> distância: custo por operação
+//                           do caminho inteiro contra a fórmula em float e
+//                           equivalência em todos os pulsos de 0 a 30 ms
+//   hcsr04_bench sound      tabela de velocidade do som: erro de k e da
+//                           distância em todos os pulsos, nas temperaturas
+//                           da tabela e nas interpoladas, contra a fórmula
+//                           exata, com limite explícito
+//   hcsr04_bench median     filtro de mediana/MAD: custo por amostra em
+//                           cada janela contra ordenar a janela (e os
+//                           desvios) a cada amostra, conferência contra a
+//                           mediana e o MAD exatos e erro numa série
+//                           ruidosa com reflexões
+//   hcsr04_bench kalman     rastreador de Kalman: erro RMS de distância e
+//                           velocidade em trajetórias sintéticas (com
+//                           ruído e medições perdidas) contra a medição
+//                           bruta, e custo por atualização; nos limites
+//                           de ruído, aceleração (e acima dela) e
+//                           intervalo, conferência do ponto fixo contra o
+//                           mesmo filtro em double
+//
+// Os tempos são do host e servem para comparar implementações entre si; no
+// Cortex-M0+ a diferença é maior, já que lá o float é emulado.
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#include "distance.h"
+#include "kalman.h"
+#include "median_filter.h"
+#include "sound.h"
+
+// Pulsos cobertos pela verificação de equivalência
+#define BENCH_PULSE_MAX_US 30000u
+// Repetições da varredura nas medições de tempo
+#define BENCH_ROUNDS 200
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Evita que o compilador descarte os laços medidos
+static volatile uint32_t sink;
+
+static float distance_cm_float(uint32_t pulse_us)
+{
+    return (pulse_us * 0.0343f) / 2.0f;
+}
+
+static int bench_distance(void)
+{
+    const uint32_t ops = (BENCH_PULSE_MAX_US + 1) * BENCH_ROUNDS;
+    char buf[32];
+
+    // Conversão
+    double t0 = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+            sink += distance_um(p, DISTANCE_K_Q8_DEFAULT);
+    double fixed_conv = (now_ns() - t0) / ops;
+
+    t0 = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+            sink += (uint32_t)(distance_cm_float(p) * 100.0f);
+    double float_conv = (now_ns() - t0) / ops;
+
+    // Conversão + formatação
+    t0 = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+            sink += distance_format_cm(buf, distance_um(p, DISTANCE_K_Q8_DEFAULT));
+    double fixed_fmt = (now_ns() - t0) / ops;
+
+    t0 = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+            sink += snprintf(buf, sizeof(buf), "%.2f", distance_cm_float(p));
+    double float_fmt = (now_ns() - t0) / ops;
+
+    // Equivalência: erro em um e texto impresso
+    uint32_t mismatches = 0;
+    uint32_t tie_mismatches = 0;
+    double max_err_um = 0;
+    for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+    {
+        double exact_um = p * 171.5;
+        double err = (double)distance_um(p, DISTANCE_K_Q8_DEFAULT) - exact_um;
+        if (err < 0)
+            err = -err;
+        if (err > max_err_um)
+            max_err_um = err;
+
+        char fixed[DISTANCE_CM_STR_MAX];
+        distance_format_cm(fixed, distance_um(p, DISTANCE_K_Q8_DEFAULT));
+        snprintf(buf, sizeof(buf), "%.2f", distance_cm_float(p));
+        if (strcmp(fixed, buf) != 0)
+        {
+            // Nos empates exatos (x,xx5 cm) o float fica um pouco abaixo e
+            // arredonda para baixo; o caminho inteiro arredonda para cima
+            if ((p * 1715u) % 1000u == 500u)
+            {
+                tie_mismatches++;
+            }
+            else
+            {
+                if (mismatches < 5)
+                    printf("  diferença em %u us: inteiro %s, float %s\n", (unsigned)p, fixed, buf);
+                mismatches++;
+            }
+        }
+    }
+
+    printf("conversão:             inteiro %.2f ns/op, float %.2f ns/op\n", fixed_conv, float_conv);
+    printf("conversão + formatação: inteiro %.2f ns/op, float %.2f ns/op\n", fixed_fmt, float_fmt);
+    printf("pulsos 0..%u us: erro máximo %.1f um, %u textos diferentes do float "
+           "(+%u empates exatos arredondados para cima)\n",
+           (unsigned)BENCH_PULSE_MAX_US, max_err_um, (unsigned)mismatches, (unsigned)tie_mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Erro de k admitido contra c(T) em double: o arredondamento de cada entrada
+// da tabela (0,5 / 39179 = 12,8 ppm), a corda da interpolação abaixo da
+// curva (h^2 / 8 * |c''/c| = 14,4 ppm a -40 °C, com h = 5 °C) e o
+// arredondamento da interpolação (mais 12,8 ppm)
+#define SOUND_BOUND_PPM 40.0
+
+static int bench_sound(void)
+{
+    // Pulso de um alvo a ~4 m, para expressar o erro em distância
+    const uint32_t pulse_us = 23300;
+
+    double max_ppm = 0;
+    int32_t worst_deci = 0;
+    double max_err_um = 0;
+    // Pior erro de distância em todos os pulsos até BENCH_PULSE_MAX_US, nas
+    // temperaturas da tabela e nas interpoladas; a distância pode errar
+    // SOUND_BOUND_PPM dela mesma mais 1 um do truncamento
+    double table_err_um = 0, interp_err_um = 0;
+    uint32_t over = 0;
+    for (int32_t t = SOUND_TEMP_MIN_DECI; t <= SOUND_TEMP_MAX_DECI; t++)
+    {
+        double exact_mm_s = 331300.0 * sqrt(1.0 + (t / 10.0) / 273.15);
+        double exact_k = exact_mm_s * 16.0 / 125.0;
+        uint32_t k = sound_k_q8(t);
+
+        double ppm = fabs(k - exact_k) / exact_k * 1e6;
+        if (ppm > max_ppm)
+        {
+            max_ppm = ppm;
+            worst_deci = t;
+        }
+        if (ppm > SOUND_BOUND_PPM)
+            over++;
+
+        double err_um = fabs((double)distance_um(pulse_us, k) - pulse_us * exact_mm_s / 2000.0);
+        if (err_um > max_err_um)
+            max_err_um = err_um;
+
+        bool in_table = (t - SOUND_TEMP_MIN_DECI) % SOUND_TEMP_STEP_DECI == 0;
+        for (uint32_t p = 0; p <= BENCH_PULSE_MAX_US; p++)
+        {
+            double exact_um = p * exact_mm_s / 2000.0;
+            double err = fabs((double)distance_um(p, k) - exact_um);
+            if (err > exact_um * SOUND_BOUND_PPM * 1e-6 + 1)
+                over++;
+            if (in_table && err > table_err_um)
+                table_err_um = err;
+            if (!in_table && err > interp_err_um)
+                interp_err_um = err;
+        }
+    }
+
+    uint32_t ops = 0;
+    double t0 = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (int32_t t = SOUND_TEMP_MIN_DECI; t <= SOUND_TEMP_MAX_DECI; t++, ops++)
+            sink += sound_k_q8(t);
+    double per_op = (now_ns() - t0) / ops;
+
+    uint32_t k20 = sound_k_q8(200);
+    double max_um = BENCH_PULSE_MAX_US * 331300.0 * sqrt(1.0 + 85.0 / 273.15) / 2000.0;
+    printf("20 C: k = %u, %u mm/s; -10 C: %u mm/s; 40 C: %u mm/s\n", (unsigned)k20,
+           (unsigned)sound_speed_mm_s(k20), (unsigned)sound_speed_mm_s(sound_k_q8(-100)),
+           (unsigned)sound_speed_mm_s(sound_k_q8(400)));
+    printf("%d..%d C: erro máximo de k %.1f ppm (em %d.%d C, limite %.0f ppm), %.0f um a 4 m\n",
+           SOUND_TEMP_MIN_DECI / 10, SOUND_TEMP_MAX_DECI / 10, max_ppm, (int)(worst_deci / 10),
+           (int)abs(worst_deci % 10), SOUND_BOUND_PPM, max_err_um);
+    printf("pulsos até %u us: erro máximo %.0f um na tabela, %.0f um interpolado (limite %.0f um), "
+           "%u fora do limite\n",
+           (unsigned)BENCH_PULSE_MAX_US, table_err_um, interp_err_um, max_um * SOUND_BOUND_PPM * 1e-6 + 1,
+           (unsigned)over);
+    printf("consulta: %.2f ns/op\n", per_op);
+    return over == 0 ? 0 : 1;
+}
+
+static uint32_t bench_rng = 1;
+
+static uint32_t bench_rand(void)
+{
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+// Normal padrão (Box-Muller)
+static double bench_gauss(void)
+{
+    double u1 = (bench_rand() + 1.0) / 4294967297.0;
+    double u2 = bench_rand() / 4294967296.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int cmp_i32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Mediana ordenando uma cópia da janela, como referência
+static int32_t naive_median(const int32_t *win, int n)
+{
+    int32_t tmp[MEDIAN_MAX_WINDOW];
+    memcpy(tmp, win, n * sizeof(int32_t));
+    qsort(tmp, n, sizeof(int32_t), cmp_i32);
+    return (n & 1) ? tmp[n / 2] : (int32_t)(((int64_t)tmp[n / 2 - 1] + tmp[n / 2]) / 2);
+}
+
+// MAD ordenando os desvios, como referência
+static int32_t naive_mad(const int32_t *win, int n, int32_t median)
+{
+    int32_t dev[MEDIAN_MAX_WINDOW];
+    for (int i = 0; i < n; i++)
+        dev[i] = abs(win[i] - median);
+    return naive_median(dev, n);
+}
+
+// Série de um alvo a 1 m: ruído gaussiano de 2 mm e 5% de reflexões que
+// dobram o caminho
+#define SERIES_LEN 100000
+#define SERIES_TRUE_UM 1000000
+#define SERIES_SIGMA_UM 2000
+#define SERIES_SPIKE_PCT 5
+
+static int bench_median(void)
+{
+    static const uint8_t windows[] = {3, 5, 9, 15, 31};
+    static int32_t series[SERIES_LEN];
+    static bool spike[SERIES_LEN];
+    double raw_sq = 0;
+    for (int i = 0; i < SERIES_LEN; i++)
+    {
+        spike[i] = bench_rand() % 100 < SERIES_SPIKE_PCT;
+        series[i] = SERIES_TRUE_UM * (spike[i] ? 2 : 1) + (int32_t)(bench_gauss() * SERIES_SIGMA_UM);
+        raw_sq += pow(series[i] - SERIES_TRUE_UM, 2);
+    }
+    printf("série de %d amostras: erro RMS bruto %.2f mm, %d%% de reflexões\n", SERIES_LEN,
+           sqrt(raw_sq / SERIES_LEN) / 1000, SERIES_SPIKE_PCT);
+    printf("janela  mediana ns  +MAD ns  ordenar ns  ordenar+MAD ns  RMS mm  reflexões pegas  falsos positivos\n");
+
+    int errors = 0, mad_errors = 0;
+    for (size_t w = 0; w < sizeof(windows); w++)
+    {
+        uint8_t n = windows[w];
+
+        // Conferência contra a mediana e o MAD exatos da janela, enchendo e
+        // rolando
+        mediator_t med;
+        mediator_init(&med, n);
+        int32_t win[MEDIAN_MAX_WINDOW];
+        for (int i = 0; i < SERIES_LEN; i++)
+        {
+            mediator_insert(&med, series[i]);
+            win[i % n] = series[i];
+            int ct = i + 1 < n ? i + 1 : n;
+            int32_t exact = naive_median(win, ct);
+            if (mediator_median(&med) != exact)
+                errors++;
+            if (mediator_mad(&med, exact) != naive_mad(win, ct, exact))
+                mad_errors++;
+        }
+
+        double t0 = now_ns();
+        mediator_init(&med, n);
+        for (int i = 0; i < SERIES_LEN; i++)
+        {
+            mediator_insert(&med, series[i]);
+            sink += (uint32_t)mediator_median(&med);
+        }
+        double t_median = (now_ns() - t0) / SERIES_LEN;
+
+        median_filter_t f;
+        median_filter_init(&f, n, MEDIAN_K_DECI_DEFAULT);
+        uint32_t caught = 0, false_pos = 0, spikes = 0;
+        double sq = 0;
+        t0 = now_ns();
+        for (int i = 0; i < SERIES_LEN; i++)
+        {
+            measurement_t m = {.distance_um = (uint32_t)series[i], .status = MEAS_OK};
+            median_filter_apply(&f, &m);
+            sink += m.distance_um;
+            if (m.status == MEAS_OUTLIER)
+            {
+                caught += spike[i];
+                false_pos += !spike[i];
+            }
+            spikes += spike[i];
+            sq += pow((double)m.distance_um - SERIES_TRUE_UM, 2);
+        }
+        double t_filter = (now_ns() - t0) / SERIES_LEN;
+
+        t0 = now_ns();
+        for (int i = 0; i < SERIES_LEN; i++)
+        {
+            win[i % n] = series[i];
+            sink += (uint32_t)naive_median(win, i + 1 < n ? i + 1 : n);
+        }
+        double t_sort = (now_ns() - t0) / SERIES_LEN;
+
+        t0 = now_ns();
+        for (int i = 0; i < SERIES_LEN; i++)
+        {
+            win[i % n] = series[i];
+            int ct = i + 1 < n ? i + 1 : n;
+            int32_t median = naive_median(win, ct);
+            sink += (uint32_t)(median + naive_mad(win, ct, median));
+        }
+        double t_sort_mad = (now_ns() - t0) / SERIES_LEN;
+
+        printf("%6u  %10.1f  %7.1f  %10.1f  %14.1f  %6.2f  %14.1f%%  %15.2f%%\n", (unsigned)n, t_median, t_filter,
+               t_sort, t_sort_mad,
+               sqrt(sq / SERIES_LEN) / 1000, 100.0 * caught / spikes, 100.0 * false_pos / (SERIES_LEN - spikes));
+    }
+    printf("%d medianas e %d MADs diferentes dos exatos\n", errors, mad_errors);
+    return errors == 0 && mad_errors == 0 ? 0 : 1;
+}
+
+// Trajetórias do rastreador, amostradas a 50 Hz: distância em um e
+// velocidade em um/s no instante t (s)
+#define TRACK_PERIOD_US 20000
+#define TRACK_SAMPLES 50000
+#define TRACK_SIGMA_UM 3000
+#define TRACK_MISS_PCT 10
+#define TRACK_SETTLE 50 // amostras ignoradas no início (convergência)
+
+typedef struct
+{
+    const char *name;
+    void (*at)(double t, double *d, double *v);
+} trajectory_t;
+
+// Vai e volta entre 0,3 m e 3,5 m a 0,4 m/s
+static void traj_approach(double t, double *d, double *v)
+{
+    double span = 3.2, speed = 0.4;
+    double x = fmod(t * speed, 2 * span);
+    *d = (x < span ? 3.5 - x : 0.3 + (x - span)) * 1e6;
+    *v = (x < span ? -speed : speed) * 1e6;
+}
+
+// 1,5 m +- 0,5 m a 0,2 Hz
+static void traj_sine(double t, double *d, double *v)
+{
+    double w = 2 * M_PI * 0.2;
+    *d = (1.5 + 0.5 * sin(w * t)) * 1e6;
+    *v = 0.5 * w * cos(w * t) * 1e6;
+}
+
+// Parado, saltando entre 1 m e 2 m a cada 5 s
+static void traj_step(double t, double *d, double *v)
+{
+    *d = (fmod(t, 10.0) < 5.0 ? 1.0 : 2.0) * 1e6;
+    *v = 0;
+}
+
+// O filtro de kalman.c em double, como referência para o ponto fixo
+typedef struct
+{
+    bool started;
+    double q, r;
+    double t, t_obs;
+    double d, v, p00, p01, p11;
+} kalman_ref_t;
+
+// Mesmo passo de kalman_predict, com dt arredondado em Q16 como lá: a
+// comparação mede só a aritmética, não a base de tempo
+static void kref_predict(kalman_ref_t *k, double t_us)
+{
+    if (!k->started || t_us <= k->t)
+        return;
+    double dt = floor((t_us - k->t) * (1 << KALMAN_FRAC_BITS) / 1e6) / (1 << KALMAN_FRAC_BITS);
+    k->t = t_us;
+    if (t_us - k->t_obs > KALMAN_RESET_US)
+    {
+        k->started = false;
+        return;
+    }
+    k->d += k->v * dt;
+    k->p00 += (2 * k->p01 + k->p11 * dt) * dt + k->q * dt * dt * dt / 3;
+    k->p01 += k->p11 * dt + k->q * dt * dt / 2;
+    k->p11 += k->q * dt;
+}
+
+static void kref_update(kalman_ref_t *k, double t_us, double z)
+{
+    kref_predict(k, t_us);
+    if (!k->started)
+    {
+        *k = (kalman_ref_t){true, k->q, k->r, t_us, t_us, z, 0, k->r, 0,
+                            (double)KALMAN_V0_SIGMA_UM_S * KALMAN_V0_SIGMA_UM_S};
+        return;
+    }
+
+    double s = k->p00 + k->r;
+    double k0 = k->p00 / s, k1 = k->p01 / s;
+    double y = z - k->d;
+    k->d += k0 * y;
+    k->v += k1 * y;
+    double p00 = k->p00, p01 = k->p01;
+    k->p00 = p00 - k0 * p00;
+    k->p01 = p01 - k0 * p01;
+    k->p11 -= k1 * p01;
+    k->t_obs = t_us;
+}
+
+// Pior caso da faixa: alvo saltando ao acaso por 0..4 m (inovações enormes)
+// em sequências de medições perdidas até quase KALMAN_RESET_US. Retorna o
+// número de desvios do ponto fixo além da tolerância.
+static int kalman_limit(uint32_t noise_um, uint32_t accel_um_s2, uint32_t period_us)
+{
+    kalman_t k;
+    kalman_init(&k, noise_um, accel_um_s2);
+    kalman_ref_t ref = {.q = (double)k.accel_um_s2 * k.accel_um_s2, .r = (double)k.noise_um * k.noise_um};
+
+    double d_err = 0, p_err = 0, p_max = 0;
+    int bad = 0;
+    uint64_t t = 1000000;
+    for (int i = 0; i < 20000; i++)
+    {
+        t += period_us;
+        // Medições perdidas até o limite do reset
+        bool miss = bench_rand() % 100 < 50 && t - k.t_obs + period_us <= KALMAN_RESET_US;
+        measurement_t m = {
+            .t_descida = t,
+            .distance_um = bench_rand() % 4000000,
+            .status = miss ? MEAS_TIMEOUT : MEAS_OK,
+        };
+        double z = m.distance_um;
+        kalman_apply(&k, &m);
+        if (miss)
+        {
+            kref_predict(&ref, (double)t);
+            continue;
+        }
+        kref_update(&ref, (double)t, z);
+
+        // O estado pode passar de 0..4 m (velocidade estimada alta); a
+        // saída é limitada em 0, o estado não
+        // Diferença em desvios padrão do próprio filtro; o estado é inteiro
+        // em um, então até 2 um é arredondamento
+        double sigma = sqrt(ref.p00);
+        double de = fabs((double)k.d - ref.d);
+        double pe = fabs((double)k.p00 - ref.p00) / ref.p00;
+        if (de / sigma > d_err)
+            d_err = de / sigma;
+        if (pe > p_err)
+            p_err = pe;
+        if (ref.p00 > p_max)
+            p_max = ref.p00;
+        if (ref.p11 > p_max)
+            p_max = ref.p11;
+        if (de > 0.01 * sigma + 2 || pe > 1e-3 || k.p00 <= 0 || k.p11 <= 0)
+            bad++;
+    }
+    printf("%8.1f  %10u  %10.0f  %14.2e  %8.1e  %9.1e  %7d\n", noise_um / 1000.0, (unsigned)(accel_um_s2 / 1000),
+           period_us / 1000.0, d_err, p_err, p_max, bad);
+    return bad;
+}
+
+static int bench_kalman(void)
+{
+    static const trajectory_t trajs[] = {
+        {"vai-e-volta", traj_approach},
+        {"senoide", traj_sine},
+        {"degraus", traj_step},
+    };
+    static const uint32_t accels[] = {100, 500, 2000}; // mm/s^2
+    static int32_t z[TRACK_SAMPLES];
+    static bool miss[TRACK_SAMPLES];
+    static double d_true[TRACK_SAMPLES], v_true[TRACK_SAMPLES];
+
+    printf("%d amostras a %d Hz, ruído %.1f mm, %d%% de medições perdidas\n", TRACK_SAMPLES,
+           1000000 / TRACK_PERIOD_US, TRACK_SIGMA_UM / 1000.0, TRACK_MISS_PCT);
+    printf("trajetória    acel mm/s2  RMS bruto mm  RMS mm  vel. bruta mm/s  vel. mm/s  ns/atualização");
+#ifdef BENCH_HAVE_TSC
+    printf("  ciclos");
+#endif
+    printf("\n");
+
+    int worse = 0;
+    for (size_t j = 0; j < sizeof(trajs) / sizeof(trajs[0]); j++)
+    {
+        for (int i = 0; i < TRACK_SAMPLES; i++)
+        {
+            trajs[j].at(i * (TRACK_PERIOD_US / 1e6), &d_true[i], &v_true[i]);
+            miss[i] = bench_rand() % 100 < TRACK_MISS_PCT;
+            z[i] = (int32_t)(d_true[i] + bench_gauss() * TRACK_SIGMA_UM);
+        }
+
+        // Referência: medição bruta e diferença entre medições válidas
+        double raw_sq = 0, raw_v_sq = 0;
+        int raw_n = 0, raw_v_n = 0, last = -1;
+        for (int i = TRACK_SETTLE; i < TRACK_SAMPLES; i++)
+        {
+            if (miss[i])
+                continue;
+            raw_sq += pow(z[i] - d_true[i], 2);
+            raw_n++;
+            if (last >= 0)
+            {
+                double v = (z[i] - z[last]) / ((i - last) * (TRACK_PERIOD_US / 1e6));
+                raw_v_sq += pow(v - v_true[i], 2);
+                raw_v_n++;
+            }
+            last = i;
+        }
+
+        for (size_t a = 0; a < sizeof(accels) / sizeof(accels[0]); a++)
+        {
+            kalman_t k;
+            kalman_init(&k, TRACK_SIGMA_UM, accels[a] * 1000);
+            double sq = 0, v_sq = 0;
+            int n = 0;
+            for (int i = 0; i < TRACK_SAMPLES; i++)
+            {
+                measurement_t m = {
+                    .t_descida = 1000000ull + (uint64_t)i * TRACK_PERIOD_US,
+                    .distance_um = (uint32_t)z[i],
+                    .status = miss[i] ? MEAS_TIMEOUT : MEAS_OK,
+                };
+                kalman_apply(&k, &m);
+                sink += m.distance_um;
+                if (i >= TRACK_SETTLE && !miss[i])
+                {
+                    sq += pow(m.distance_um - d_true[i], 2);
+                    v_sq += pow(m.velocity_um_s - v_true[i], 2);
+                    n++;
+                }
+            }
+
+            // Só o filtro, sem o cálculo do erro
+            kalman_init(&k, TRACK_SIGMA_UM, accels[a] * 1000);
+            double t0 = now_ns();
+#ifdef BENCH_HAVE_TSC
+            uint64_t c0 = __rdtsc();
+#endif
+            for (int i = 0; i < TRACK_SAMPLES; i++)
+            {
+                measurement_t m = {
+                    .t_descida = 1000000ull + (uint64_t)i * TRACK_PERIOD_US,
+                    .distance_um = (uint32_t)z[i],
+                    .status = miss[i] ? MEAS_TIMEOUT : MEAS_OK,
+                };
+                kalman_apply(&k, &m);
+                sink += m.distance_um;
+            }
+#ifdef BENCH_HAVE_TSC
+            double cycles = (double)(__rdtsc() - c0) / TRACK_SAMPLES;
+#endif
+            double t_update = (now_ns() - t0) / TRACK_SAMPLES;
+
+            double rms = sqrt(sq / n), raw_rms = sqrt(raw_sq / raw_n);
+            if (rms >= raw_rms && trajs[j].at != traj_step)
+                worse++;
+            printf("%-12s  %10u  %12.2f  %6.2f  %15.1f  %9.1f  %14.1f", trajs[j].name, (unsigned)accels[a],
+                   raw_rms / 1000, rms / 1000, sqrt(raw_v_sq / raw_v_n) / 1000, sqrt(v_sq / n) / 1000, t_update);
+#ifdef BENCH_HAVE_TSC
+            printf("  %6.0f", cycles);
+#endif
+            printf("\n");
+        }
+    }
+
+    // Acima de KALMAN_ACCEL_MAX_UM_S2 kalman_init limita
+    static const uint32_t lim_noise[] = {100, KALMAN_NOISE_MAX_UM};
+    static const uint32_t lim_accel[] = {KALMAN_ACCEL_MAX_UM_S2, 4u * KALMAN_ACCEL_MAX_UM_S2};
+    static const uint32_t lim_period[] = {20000, 1000000, KALMAN_RESET_US - 10000};
+    printf("\nlimites: ponto fixo contra double\n");
+    printf("ruído mm  acel mm/s2  período ms  erro máx sigma  erro P00  P máx um2  desvios\n");
+    int bad = 0;
+    for (size_t n = 0; n < sizeof(lim_noise) / sizeof(lim_noise[0]); n++)
+        for (size_t a = 0; a < sizeof(lim_accel) / sizeof(lim_accel[0]); a++)
+            for (size_t p = 0; p < sizeof(lim_period) / sizeof(lim_period[0]); p++)
+                bad += kalman_limit(lim_noise[n], lim_accel[a], lim_period[p]);
+
+    return worse == 0 && bad == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "kalman") == 0)
+        return bench_kalman();
+    if (argc > 1 && strcmp(argv[1], "median") == 0)
+        return bench_median();
+    if (argc > 1 && strcmp(argv[1], "sound") == 0)
+        return bench_sound();
+    if (argc > 1 && strcmp(argv[1], "distance") == 0)
+        return bench_distance();
+
+    fprintf(stderr, "uso: hcsr04_bench distance|sound|median|kalman\n");
+    return 1;
+}
@@ -0,0 +1,141 @@
+// Decodificador da saída binária do firmware ('format bin').
+//
+//   hcsr04_decode [arquivo]     lê o fluxo (ou a entrada padrão, ou a porta
+//                               serial, ex.: /dev/ttyACM0) e imprime CSV
+//   hcsr04_decode --bench [n]   mede a vazão de decodificação com n quadros
+//
+// Lacunas na sequência (quadros perdidos) e quadros corrompidos são
+// contados e relatados no fim, na saída de erro.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "frame.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int decode_stream(FILE *in)
+{
+    frame_reader_t reader;
+    frame_reader_init(&reader);
+
+    printf("seq,timestamp_us,sensor,pulse_us,distance_um,status,velocity_um_s,shots,valid,min_um,max_um\n");
+
+    uint32_t lost = 0;
+    uint32_t repeated = 0;
+    uint32_t other = 0;
+    bool have_seq = false;
+    uint32_t next_seq = 0;
+
+    int c;
+    while ((c = fgetc(in)) != EOF)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        size_t len;
+        if (!frame_reader_feed(&reader, (uint8_t)c, payload, &len))
+            continue;
+
+        // Transições do intertravamento vão para stderr, fora do CSV
+        threshold_event_t e;
+        if (frame_unpack_threshold(payload, len, &e))
+        {
+            fprintf(stderr, "intertravamento: %u us, sensor %u %s, %ld um, latência %u us\n", (unsigned)e.t_us,
+                    (unsigned)e.sensor, e.near ? "perto" : "longe",
+                    e.distance_um == THRESHOLD_NO_ECHO ? -1L : (long)e.distance_um, (unsigned)e.latency_us);
+            continue;
+        }
+
+        measurement_t m;
+        if (!frame_unpack_measurement(payload, len, &m))
+        {
+            other++;
+            continue;
+        }
+
+        // seq é o id do disparo; um registro de 'avg' cobre shots disparos
+        int32_t gap = (int32_t)(m.seq - next_seq);
+        if (have_seq && gap > 0)
+            lost += (uint32_t)gap;
+        else if (have_seq && gap < 0)
+            repeated++;
+        if (!have_seq || gap >= 0)
+            next_seq = m.seq + m.shots;
+        have_seq = true;
+
+        printf("%u,%llu,%u,%u,%u,%u,%d,%u,%u,%u,%u\n", (unsigned)m.seq, (unsigned long long)m.t_descida,
+               (unsigned)m.sensor, (unsigned)m.pulse_us, (unsigned)m.distance_um, (unsigned)m.status,
+               (int)m.velocity_um_s, (unsigned)m.shots, (unsigned)m.valid, (unsigned)m.min_um, (unsigned)m.max_um);
+    }
+
+    fprintf(stderr, "%u quadros, %u inválidos, %u de outro tipo, %u disparos perdidos pela sequência, "
+            "%u repetidos ou fora de ordem\n",
+            (unsigned)reader.frames, (unsigned)reader.errors, (unsigned)other, (unsigned)lost, (unsigned)repeated);
+    return 0;
+}
+
+static int bench(unsigned long n)
+{
+    uint8_t *stream = malloc(n * FRAME_MAX_ENCODED);
+    if (!stream)
+        return 1;
+
+    size_t total = 0;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        measurement_t m = {
+            .t_descida = 1000000ull + i * 20000ull,
+            .seq = (uint32_t)i,
+            .pulse_us = (uint32_t)(i * 37 % 30000),
+            .distance_um = (uint32_t)(i * 37 % 30000) * 171,
+            .sensor = (uint8_t)(i % 8),
+            .status = MEAS_OK,
+        };
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        total += frame_encode(payload, frame_pack_measurement(&m, payload), stream + total);
+    }
+
+    frame_reader_t reader;
+    frame_reader_init(&reader);
+    uint64_t check = 0;
+
+    double t0 = now_s();
+    for (size_t i = 0; i < total; i++)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        size_t len;
+        measurement_t m;
+        if (frame_reader_feed(&reader, stream[i], payload, &len) && frame_unpack_measurement(payload, len, &m))
+            check += m.seq;
+    }
+    double dt = now_s() - t0;
+
+    printf("%lu quadros (%zu bytes) em %.3f s: %.1f MB/s, %.2f M quadros/s, %u erros\n", n, total, dt,
+           total / dt / 1e6, reader.frames / dt / 1e6, (unsigned)reader.errors);
+    free(stream);
+    return (reader.frames == n && check == (uint64_t)n * (n - 1) / 2) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return bench(argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000ul);
+
+    FILE *in = stdin;
+    if (argc > 1 && strcmp(argv[1], "-") != 0)
+    {
+        in = fopen(argv[1], "rb");
+        if (!in)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    return decode_stream(in);
+}
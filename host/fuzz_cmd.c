@@ -0,0 +1,199 @@
+// Harness de fuzzing do interpretador de comandos (main/cmd.c).
+//
+// Com clang e -DHOST_FUZZ=ON é um alvo do libFuzzer:
+//   ./hcsr04_fuzz_cmd -max_total_time=60
+// Sem libFuzzer, o main() abaixo gera entradas pseudoaleatórias:
+//   ./hcsr04_fuzz_cmd [iterações] [semente]
+//
+// Além de procurar falhas de memória, confere que todo handler chamado
+// recebeu uma quantidade de argumentos dentro da especificação e que os
+// números aceitos batem com uma conversão de referência.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmd.h"
+#include "line_input.h"
+
+static const cmd_def_t *current;
+static char tokens[CMD_MAX_ARGS + 1][LINE_MAX_LEN + 1];
+static int token_count;
+
+static void fail(const char *why, const char *line)
+{
+    fprintf(stderr, "falha: %s na linha '%s'\n", why, line);
+    abort();
+}
+
+static bool check_handler(int argc, const cmd_arg_t *argv)
+{
+    if (argc < current->min_args || argc > (int)strlen(current->args) || argc + 1 != token_count)
+        fail("quantidade de argumentos", tokens[0]);
+
+    for (int i = 0; i < argc; i++)
+    {
+        const char *tok = tokens[i + 1];
+        switch (current->args[i])
+        {
+        case 'u':
+            if (strtoull(tok, NULL, 10) != argv[i].u)
+                fail("inteiro sem sinal", tok);
+            break;
+        case 'i':
+            if (strtoll(tok, NULL, 10) != argv[i].i)
+                fail("inteiro", tok);
+            break;
+        case 'd':
+        {
+            double ref = strtod(tok, NULL) * 10.0;
+            double diff = ref - argv[i].i;
+            if (diff > 0.5 || diff < -0.5)
+                fail("decimal", tok);
+            break;
+        }
+        case 'w':
+            if (strcmp(tok, argv[i].w) != 0)
+                fail("palavra", tok);
+            break;
+        }
+    }
+    return (argc & 1) == 0;
+}
+
+static bool handler_a(int argc, const cmd_arg_t *argv)
+{
+    return check_handler(argc, argv);
+}
+
+static bool handler_b(int argc, const cmd_arg_t *argv)
+{
+    return check_handler(argc, argv);
+}
+
+// Cobre todos os tipos de argumento e combinações de opcionais
+static const cmd_def_t table[] = {
+    {"a", handler_a, "", 0, ""},
+    {"deci", handler_b, "dd", 1, ""},
+    {"int", handler_a, "i", 1, ""},
+    {"mix", handler_b, "uidw", 2, ""},
+    {"uint", handler_a, "u", 0, ""},
+    {"word", handler_b, "ww", 0, ""},
+};
+
+#define TABLE_LEN (sizeof(table) / sizeof(table[0]))
+
+static void split_reference(const char *line)
+{
+    token_count = 0;
+    const char *p = line;
+    while (*p)
+    {
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (!*p)
+            break;
+        size_t n = strcspn(p, " \t");
+        if (token_count <= CMD_MAX_ARGS)
+        {
+            memcpy(tokens[token_count], p, n);
+            tokens[token_count][n] = '\0';
+        }
+        token_count++;
+        p += n;
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // Mesmas condições do firmware: linha sem terminador, até LINE_MAX_LEN
+    char line[LINE_MAX_LEN + 1];
+    size_t n = 0;
+    for (size_t i = 0; i < size && n < LINE_MAX_LEN; i++)
+    {
+        if (data[i] != '\0' && data[i] != '\n' && data[i] != '\r')
+            line[n++] = (char)data[i];
+    }
+    line[n] = '\0';
+
+    split_reference(line);
+    current = NULL;
+    if (token_count > 0)
+    {
+        for (size_t i = 0; i < TABLE_LEN; i++)
+        {
+            if (strcmp(tokens[0], table[i].name) == 0)
+                current = &table[i];
+        }
+    }
+
+    char copy[LINE_MAX_LEN + 1];
+    memcpy(copy, line, n + 1);
+    const cmd_def_t *matched;
+    cmd_status_t st = cmd_execute(table, TABLE_LEN, copy, &matched);
+
+    if (token_count == 0 && st != CMD_EMPTY)
+        fail("linha vazia", line);
+    if (token_count > 0 && (current == NULL) != (st == CMD_UNKNOWN))
+        fail("busca na tabela", line);
+    if (matched != current)
+        fail("comando encontrado", line);
+    return 0;
+}
+
+#ifndef HOST_FUZZ
+// Gerador simples: palavras do vocabulário da tabela, números de bordas e
+// bytes quaisquer
+static const char *const vocab[] = {
+    "a", "deci", "int", "mix", "uint", "word", "0", "1", "-1", "4294967295", "4294967296",
+    "2147483647", "-2147483648", "-2147483649", "12.5", "-0.5", "1.", ".5", "1.23", "--1",
+    "abc", "", " ", "\t", "007", "99999999999999999999",
+};
+
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+int main(int argc, char **argv)
+{
+    if (!cmd_table_sorted(table, TABLE_LEN))
+        fail("tabela fora de ordem", "");
+
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000ul;
+    rng_state = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 0x12345678u;
+
+    uint8_t buf[2 * LINE_MAX_LEN];
+    for (unsigned long it = 0; it < iterations; it++)
+    {
+        size_t len = 0;
+        int words = (int)(rng() % 7);
+        for (int w = 0; w < words && len < sizeof(buf) - 24; w++)
+        {
+            if (rng() % 4 == 0)
+            {
+                size_t k = rng() % 6;
+                for (size_t j = 0; j < k; j++)
+                    buf[len++] = (uint8_t)rng();
+            }
+            else
+            {
+                const char *v = vocab[rng() % (sizeof(vocab) / sizeof(vocab[0]))];
+                size_t k = strlen(v);
+                memcpy(buf + len, v, k);
+                len += k;
+            }
+            buf[len++] = (rng() % 3) ? ' ' : '\t';
+        }
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    printf("%lu entradas sem falhas\n", iterations);
+    return 0;
+}
+#endif
@@ -0,0 +1,158 @@
+// Roda a aplicação do firmware (acq.c, app.c, commands.c) no host, sobre o
+// HAL simulado (hal_sim.c), em tempo virtual:
+//
+//   hcsr04_fw [opções] [segundos]
+//
+//   -d <cm>      distância do alvo (padrão 100; < 0 = sem alvo)
+//   -v <cm/s>    velocidade de aproximação do alvo
+//   -n <us>      ruído máximo (±) em cada borda do echo
+//   -p <pct>     triggers sem echo
+//   -s <pct>     echoes presos em alto
+//   -m <pct>     echoes de uma reflexão dupla (distância 2x)
+//   -t <C>       temperatura do sensor interno
+//   -r <seed>    semente do ruído
+//   -c <cmd>     comando enviado no início; "<ms>:<cmd>" envia em <ms>.
+//                Pode repetir. Sem -c, envia "start".
+//
+// A saída é a mesma que o firmware mandaria pela serial. Ao fim, o modelo
+// do sensor imprime seus contadores em stderr.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "acq.h"
+#include "app.h"
+#include "config.h"
+#include "hal_sim.h"
+
+// Período de uma volta dos loops simulados (o core1 gira sem dormir)
+#define FW_SIM_STEP_US 10
+#define FW_SIM_MAX_COMMANDS 16
+
+typedef struct
+{
+    uint64_t at_us;
+    const char *line;
+} fw_command_t;
+
+// Alvo se aproximando em velocidade constante
+typedef struct
+{
+    int32_t start_mm;
+    int32_t speed_mm_s;
+} fw_target_t;
+
+static int32_t fw_target_mm(uint64_t t_us, void *ctx)
+{
+    const fw_target_t *target = ctx;
+    int64_t mm = target->start_mm - (int64_t)target->speed_mm_s * (int64_t)t_us / 1000000;
+    return mm < 0 ? 0 : (int32_t)mm;
+}
+
+int main(int argc, char **argv)
+{
+    fw_target_t target = {.start_mm = 1000};
+    uint32_t noise_us = 0, dropout_pct = 0, stuck_pct = 0, multipath_pct = 0, seed = 1;
+    int32_t temp_deci = 200;
+    fw_command_t commands[FW_SIM_MAX_COMMANDS];
+    int command_count = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:v:n:p:s:m:t:r:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            target.start_mm = (int32_t)(atof(optarg) * 10);
+            break;
+        case 'v':
+            target.speed_mm_s = (int32_t)(atof(optarg) * 10);
+            break;
+        case 'n':
+            noise_us = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'p':
+            dropout_pct = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            stuck_pct = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'm':
+            multipath_pct = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            temp_deci = (int32_t)(atof(optarg) * 10);
+            break;
+        case 'r':
+            seed = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+        {
+            if (command_count == FW_SIM_MAX_COMMANDS)
+                break;
+            char *colon = strchr(optarg, ':');
+            fw_command_t *c = &commands[command_count++];
+            c->at_us = colon ? strtoull(optarg, NULL, 10) * 1000 : 0;
+            c->line = colon ? colon + 1 : optarg;
+            break;
+        }
+        default:
+            fprintf(stderr, "uso: hcsr04_fw [-d cm] [-v cm/s] [-n us] [-p pct] [-s pct] [-m pct] [-t C] [-r seed] "
+                            "[-c [ms:]cmd]... [segundos]\n");
+            return 2;
+        }
+    }
+    uint64_t duration_us = (uint64_t)((optind < argc ? atof(argv[optind]) : 5.0) * 1e6);
+    if (command_count == 0)
+        commands[command_count++] = (fw_command_t){0, "start"};
+
+    hal_sim_reset(seed);
+    hal_sim_set_temperature(temp_deci);
+    const uint8_t pins[SENSOR_MAX][2] = SENSOR_PIN_TABLE;
+    hal_sim_sensor_t *models[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        hal_sim_sensor_t *s = models[i] = hal_sim_add_sensor(pins[i][0], pins[i][1]);
+        s->profile = target.start_mm < 0 ? NULL : fw_target_mm;
+        s->profile_ctx = &target;
+        s->distance_mm = -1;
+        s->noise_us = noise_us;
+        s->dropout_pct = dropout_pct;
+        s->stuck_pct = stuck_pct;
+        s->multipath_pct = multipath_pct;
+    }
+
+    acq_init();
+    acq_setup();
+    app_init();
+
+    while (hal_time_us() < duration_us)
+    {
+        for (int i = 0; i < command_count; i++)
+        {
+            if (commands[i].line && hal_time_us() >= commands[i].at_us)
+            {
+                char line[LINE_MAX_LEN + 2];
+                snprintf(line, sizeof(line), "%s\n", commands[i].line);
+                hal_sim_input(line);
+                commands[i].line = NULL;
+            }
+        }
+
+        acq_poll();
+        app_poll();
+        hal_sim_advance(FW_SIM_STEP_US);
+    }
+    fflush(stdout);
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        const hal_sim_sensor_stats_t *st = &models[i]->stats;
+        fprintf(stderr, "modelo %d: %u triggers (%u ignorados), %u echoes, %u sem alvo, %u perdidos, %u presos, %u reflexões duplas\n", i,
+                (unsigned)st->triggers, (unsigned)st->ignored, (unsigned)st->echoes, (unsigned)st->no_target,
+                (unsigned)st->dropouts, (unsigned)st->stuck, (unsigned)st->multipath);
+    }
+    return 0;
+}
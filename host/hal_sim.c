@@ -0,0 +1,473 @@
+#include "hal_sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "temp_sensor.h"
+
+typedef enum
+{
+    EV_NONE = 0,
+    EV_ALARM,
+    EV_EDGE,
+} event_kind_t;
+
+typedef struct
+{
+    event_kind_t kind;
+    uint64_t t;
+    uint32_t order; // desempate entre eventos no mesmo instante
+    int32_t id;
+    hal_alarm_cb_t cb;
+    void *user;
+    unsigned int pin;
+    bool level;
+} sim_event_t;
+
+static uint64_t now_us;
+static uint32_t rng;
+
+static sim_event_t events[HAL_SIM_MAX_EVENTS];
+static uint32_t event_order;
+static int32_t next_alarm_id;
+
+static bool pin_level[HAL_GPIO_COUNT];
+static uint32_t irq_events[HAL_GPIO_COUNT];
+static hal_gpio_irq_cb_t irq_cb;
+
+// IRQ crua: bordas dos pinos de raw_mask ficam pendentes até o handler
+// reconhecê-las
+static uint32_t raw_mask;
+static hal_irq_handler_t raw_handler;
+static uint32_t irq_pending[HAL_GPIO_COUNT];
+
+static hal_sim_sensor_t sensors[HAL_SIM_MAX_SENSORS];
+static int sensor_count;
+
+static hal_rx_cb_t rx_cb;
+static void *rx_param;
+static char rx_buf[256];
+static size_t rx_head;
+static size_t rx_tail;
+
+static hal_sim_writer_t out_writer;
+static void *out_ctx;
+static size_t out_writable;
+
+static int32_t temperature_deci = 200;
+static uint32_t irq_count;
+
+const char hal_stdio_eol[] = "\n";
+
+static uint32_t sim_rand(void)
+{
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Desvio uniforme em -max..+max
+static int32_t sim_jitter(uint32_t max)
+{
+    if (max == 0)
+        return 0;
+    return (int32_t)(sim_rand() % (2 * max + 1)) - (int32_t)max;
+}
+
+static bool sim_event_add(const sim_event_t *ev)
+{
+    for (int i = 0; i < HAL_SIM_MAX_EVENTS; i++)
+    {
+        if (events[i].kind == EV_NONE)
+        {
+            events[i] = *ev;
+            events[i].order = event_order++;
+            return true;
+        }
+    }
+    return false;
+}
+
+static sim_event_t *sim_event_first(void)
+{
+    sim_event_t *first = NULL;
+    for (int i = 0; i < HAL_SIM_MAX_EVENTS; i++)
+    {
+        sim_event_t *ev = &events[i];
+        if (ev->kind == EV_NONE)
+            continue;
+        if (first == NULL || ev->t < first->t || (ev->t == first->t && ev->order < first->order))
+            first = ev;
+    }
+    return first;
+}
+
+static void sim_edge(unsigned int pin, bool level, uint64_t t)
+{
+    sim_event_add(&(sim_event_t){.kind = EV_EDGE, .t = t, .pin = pin, .level = level});
+}
+
+// Fim do pulso de trigger: o sensor agenda o echo conforme o modelo
+static void sensor_triggered(hal_sim_sensor_t *s)
+{
+    s->stats.triggers++;
+    if (now_us - s->trig_rise_at < 10 || now_us < s->busy_until)
+    {
+        s->stats.ignored++;
+        return;
+    }
+
+    uint64_t rise = now_us + s->rise_delay_us + (uint64_t)(int64_t)sim_jitter(s->noise_us);
+    if (sim_rand() % 100 < s->dropout_pct)
+    {
+        s->stats.dropouts++;
+        s->busy_until = rise;
+        return;
+    }
+
+    uint32_t width;
+    int32_t mm = s->profile ? s->profile(now_us, s->profile_ctx) : s->distance_mm;
+    if (sim_rand() % 100 < s->stuck_pct)
+    {
+        s->stats.stuck++;
+        width = s->stuck_us;
+    }
+    else if (mm < 0 || (uint32_t)mm > s->max_range_mm)
+    {
+        s->stats.no_target++;
+        width = s->no_target_us;
+    }
+    else
+    {
+        s->stats.echoes++;
+        if (sim_rand() % 100 < s->multipath_pct && (uint32_t)mm * 2 <= s->max_range_mm)
+        {
+            s->stats.multipath++;
+            mm *= 2;
+        }
+        int64_t w = ((int64_t)mm * 2000000 + s->speed_mm_s / 2) / s->speed_mm_s + sim_jitter(s->noise_us);
+        width = w < 1 ? 1 : (uint32_t)w;
+    }
+
+    sim_edge(s->echo, true, rise);
+    sim_edge(s->echo, false, rise + width);
+    s->busy_until = rise + width;
+}
+
+void hal_sim_reset(uint32_t seed)
+{
+    now_us = 0;
+    rng = seed ? seed : 1;
+    memset(events, 0, sizeof(events));
+    event_order = 0;
+    next_alarm_id = 1;
+    memset(pin_level, 0, sizeof(pin_level));
+    memset(irq_events, 0, sizeof(irq_events));
+    irq_cb = NULL;
+    raw_mask = 0;
+    raw_handler = NULL;
+    memset(irq_pending, 0, sizeof(irq_pending));
+    sensor_count = 0;
+    rx_cb = NULL;
+    rx_head = rx_tail = 0;
+    out_writer = NULL;
+    out_writable = 4096;
+    temperature_deci = 200;
+    irq_count = 0;
+}
+
+hal_sim_sensor_t *hal_sim_add_sensor(unsigned int trig, unsigned int echo)
+{
+    if (sensor_count >= HAL_SIM_MAX_SENSORS)
+        return NULL;
+
+    hal_sim_sensor_t *s = &sensors[sensor_count++];
+    *s = (hal_sim_sensor_t){
+        .trig = trig,
+        .echo = echo,
+        .distance_mm = 1000,
+        .speed_mm_s = 343000,
+        .max_range_mm = 4000,
+        .rise_delay_us = 450,
+        .no_target_us = 38000,
+        .stuck_us = 200000,
+    };
+    return s;
+}
+
+// Aplica uma borda ao pino. Retorna true se ela ficou pendente para o
+// handler cru; no callback comum ele já foi chamado.
+static bool sim_pin_set(unsigned int pin, bool level)
+{
+    if (pin_level[pin] == level)
+        return false;
+
+    pin_level[pin] = level;
+    uint32_t edge = level ? HAL_EDGE_RISE : HAL_EDGE_FALL;
+    if (!(irq_events[pin] & edge))
+        return false;
+
+    if (raw_handler && (raw_mask & (1u << pin)))
+    {
+        irq_pending[pin] |= edge;
+        return true;
+    }
+    if (irq_cb)
+    {
+        irq_count++;
+        irq_cb(pin, edge);
+    }
+    return false;
+}
+
+void hal_sim_advance(uint64_t us)
+{
+    uint64_t target = now_us + us;
+    sim_event_t *ev;
+    while ((ev = sim_event_first()) != NULL && ev->t <= target)
+    {
+        sim_event_t e = *ev;
+        ev->kind = EV_NONE;
+        if (e.t > now_us)
+            now_us = e.t;
+
+        if (e.kind == EV_ALARM)
+        {
+            irq_count++;
+            e.cb(e.id, e.user);
+        }
+        else if (sim_pin_set(e.pin, e.level))
+        {
+            // Bordas no mesmo instante chegam ao handler cru na mesma IRQ
+            while ((ev = sim_event_first()) != NULL && ev->kind == EV_EDGE && ev->t == now_us)
+            {
+                ev->kind = EV_NONE;
+                sim_pin_set(ev->pin, ev->level);
+            }
+            irq_count++;
+            raw_handler();
+        }
+    }
+    now_us = target;
+}
+
+uint64_t hal_sim_next_event(void)
+{
+    sim_event_t *ev = sim_event_first();
+    return ev ? ev->t : UINT64_MAX;
+}
+
+void hal_sim_input(const char *s)
+{
+    for (; *s; s++)
+    {
+        size_t next = (rx_head + 1) % sizeof(rx_buf);
+        if (next == rx_tail)
+            break;
+        rx_buf[rx_head] = *s;
+        rx_head = next;
+    }
+    if (rx_cb)
+        rx_cb(rx_param);
+}
+
+void hal_sim_set_output(hal_sim_writer_t writer, void *ctx)
+{
+    out_writer = writer;
+    out_ctx = ctx;
+}
+
+void hal_sim_set_writable(size_t bytes)
+{
+    out_writable = bytes;
+}
+
+uint32_t hal_sim_irq_count(void)
+{
+    return irq_count;
+}
+
+void hal_sim_set_temperature(int32_t deci)
+{
+    temperature_deci = deci;
+}
+
+// hal.h
+
+uint64_t hal_time_us(void)
+{
+    return now_us;
+}
+
+uint32_t hal_time_us32(void)
+{
+    return (uint32_t)now_us;
+}
+
+void hal_sleep_us(uint32_t us)
+{
+    hal_sim_advance(us);
+}
+
+void hal_gpio_output(unsigned int pin)
+{
+    pin_level[pin] = false;
+}
+
+void hal_gpio_input(unsigned int pin)
+{
+}
+
+void hal_gpio_put(unsigned int pin, bool value)
+{
+    for (int i = 0; i < sensor_count; i++)
+    {
+        hal_sim_sensor_t *s = &sensors[i];
+        if (s->trig != pin)
+            continue;
+
+        if (value && !s->trig_high)
+            s->trig_rise_at = now_us;
+        else if (!value && s->trig_high)
+            sensor_triggered(s);
+        s->trig_high = value;
+    }
+    pin_level[pin] = value;
+}
+
+void hal_gpio_irq_enable(unsigned int pin, uint32_t events_mask, hal_gpio_irq_cb_t cb)
+{
+    irq_events[pin] = events_mask;
+    irq_cb = cb;
+}
+
+void hal_gpio_raw_irq_enable(uint32_t pin_mask, uint32_t events, hal_irq_handler_t handler)
+{
+    for (unsigned int pin = 0; pin < HAL_GPIO_COUNT; pin++)
+    {
+        if (pin_mask & (1u << pin))
+            irq_events[pin] = events;
+    }
+    raw_mask |= pin_mask;
+    raw_handler = handler;
+}
+
+void hal_gpio_raw_irq_disable(uint32_t pin_mask, hal_irq_handler_t handler)
+{
+    raw_mask &= ~pin_mask;
+    if (raw_mask == 0)
+        raw_handler = NULL;
+}
+
+uint32_t hal_gpio_irq_events(unsigned int pin)
+{
+    return irq_pending[pin];
+}
+
+void hal_gpio_irq_ack(unsigned int pin, uint32_t events)
+{
+    irq_pending[pin] &= ~events;
+}
+
+uint32_t hal_gpio_get_all(void)
+{
+    uint32_t levels = 0;
+    for (unsigned int pin = 0; pin < HAL_GPIO_COUNT; pin++)
+        levels |= (uint32_t)pin_level[pin] << pin;
+    return levels;
+}
+
+// Os callbacks rodam num instante só do relógio virtual: não há ciclos a
+// contar, e os contadores dos caminhos de IRQ ficam em zero
+void hal_cycles_init(void)
+{
+}
+
+uint32_t hal_cycles(void)
+{
+    return 0;
+}
+
+uint32_t hal_gpio_irq_entry(void)
+{
+    return 0;
+}
+
+void hal_alarm_init(unsigned int max_alarms)
+{
+}
+
+int32_t hal_alarm_add_us(uint32_t delay_us, hal_alarm_cb_t cb, void *user)
+{
+    int32_t id = next_alarm_id++;
+    if (!sim_event_add(&(sim_event_t){.kind = EV_ALARM, .t = now_us + delay_us, .id = id, .cb = cb, .user = user}))
+        return -1;
+    return id;
+}
+
+void hal_alarm_cancel(int32_t id)
+{
+    for (int i = 0; i < HAL_SIM_MAX_EVENTS; i++)
+    {
+        if (events[i].kind == EV_ALARM && events[i].id == id)
+            events[i].kind = EV_NONE;
+    }
+}
+
+uint32_t hal_irq_save(void)
+{
+    return 0;
+}
+
+void hal_irq_restore(uint32_t saved)
+{
+}
+
+void hal_event_signal(void)
+{
+}
+
+void hal_event_wait(void)
+{
+}
+
+void hal_stdio_set_rx_callback(hal_rx_cb_t cb, void *param)
+{
+    rx_cb = cb;
+    rx_param = param;
+}
+
+int hal_stdio_getchar(void)
+{
+    if (rx_tail == rx_head)
+        return -1;
+    int ch = (unsigned char)rx_buf[rx_tail];
+    rx_tail = (rx_tail + 1) % sizeof(rx_buf);
+    return ch;
+}
+
+size_t hal_stdio_writable(void)
+{
+    return out_writable;
+}
+
+void hal_stdio_write(const uint8_t *data, size_t len)
+{
+    if (out_writer)
+        out_writer(data, len, out_ctx);
+    else
+        fwrite(data, 1, len, stdout);
+}
+
+// temp_sensor.h
+
+void temp_sensor_init(void)
+{
+}
+
+int32_t temp_sensor_read_deci(void)
+{
+    return temperature_deci;
+}
@@ -0,0 +1,90 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+// HAL de host: relógio virtual determinístico, fila de eventos (alarmes e
+// bordas de echo) e um modelo do HC-SR04 ligado a cada par TRIG/ECHO.
+// Nada avança sozinho: o laço do simulador chama hal_sim_advance entre as
+// voltas de acq_poll()/app_poll(), e os callbacks rodam nesse momento, com
+// hal_time_us() igual ao instante do evento.
+
+#define HAL_SIM_MAX_SENSORS 8
+#define HAL_SIM_MAX_EVENTS 64
+
+// Distância do alvo em mm no instante t; < 0 = nenhum alvo ao alcance
+typedef int32_t (*hal_sim_profile_t)(uint64_t t_us, void *ctx);
+
+typedef struct
+{
+    uint32_t triggers;
+    uint32_t ignored;  // triggers com o echo ainda ocupado
+    uint32_t echoes;   // pulsos de echo completos com alvo
+    uint32_t no_target; // pulsos longos sem alvo
+    uint32_t dropouts; // triggers sem nenhum echo
+    uint32_t stuck;    // echoes presos em alto
+    uint32_t multipath; // echoes da reflexão dupla
+} hal_sim_sensor_stats_t;
+
+// Modelo do HC-SR04. Os campos de configuração podem ser mudados a
+// qualquer momento; valem a partir do próximo trigger.
+typedef struct
+{
+    unsigned int trig;
+    unsigned int echo;
+
+    int32_t distance_mm; // alvo fixo, usado se profile == NULL
+    hal_sim_profile_t profile;
+    void *profile_ctx;
+
+    uint32_t speed_mm_s;    // velocidade do som no ar simulado
+    uint32_t max_range_mm;  // além disso o sensor não vê o alvo
+    uint32_t rise_delay_us; // fim do trigger -> subida do echo
+    uint32_t no_target_us;  // largura do echo sem alvo
+    uint32_t noise_us;      // desvio máximo (±) de cada borda
+    uint32_t dropout_pct;   // triggers sem echo
+    uint32_t multipath_pct; // echoes de uma reflexão dupla (caminho 2x)
+    uint32_t stuck_pct;     // echoes que ficam em alto por stuck_us
+    uint32_t stuck_us;
+
+    hal_sim_sensor_stats_t stats;
+
+    // Estado interno
+    uint64_t trig_rise_at;
+    bool trig_high;
+    uint64_t busy_until;
+} hal_sim_sensor_t;
+
+// Zera relógio, eventos, pinos e sensores; seed alimenta o ruído
+void hal_sim_reset(uint32_t seed);
+
+// Liga um modelo ao par de pinos, com os padrões de um HC-SR04 típico a
+// 1 m de distância
+hal_sim_sensor_t *hal_sim_add_sensor(unsigned int trig, unsigned int echo);
+
+// Avança o relógio virtual em us, atendendo os eventos no caminho
+void hal_sim_advance(uint64_t us);
+
+// Instante do próximo evento pendente, UINT64_MAX se nenhum
+uint64_t hal_sim_next_event(void);
+
+// Entrega bytes ao stdio simulado, como a IRQ de recepção
+void hal_sim_input(const char *s);
+
+// Destino da saída da aplicação (padrão: stdout) e quanto ela aceita por
+// volta do loop
+typedef void (*hal_sim_writer_t)(const uint8_t *data, size_t len, void *ctx);
+void hal_sim_set_output(hal_sim_writer_t writer, void *ctx);
+void hal_sim_set_writable(size_t bytes);
+
+// Callbacks de IRQ (bordas e alarmes) atendidos desde o reset
+uint32_t hal_sim_irq_count(void);
+
+// Temperatura devolvida por temp_sensor_read_deci()
+void hal_sim_set_temperature(int32_t deci);
+
+#endif
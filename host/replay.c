@@ -0,0 +1,366 @@
+// Reprodução offline de um registro do modo trace ('trace on').
+//
+//   hcsr04_replay [-q] [-t C] [-f janela[,k]] [arquivo]
+//
+// Lê o fluxo binário do firmware (arquivo, entrada padrão ou porta serial),
+// passa cada trigger, borda e timeout registrado pela mesma máquina de
+// estados do sensor e pela mesma conversão de distância do firmware, e
+// imprime as medições reconstruídas em CSV (-q omite o CSV). -t fixa a
+// temperatura da compensação do som (padrão: fator de 343 m/s). -f liga
+// em todos os sensores o filtro de mediana do firmware ('filter'), com k em
+// MADs (padrão 3); o resumo traz o desvio padrão das distâncias antes e
+// depois dele, e cada saída do filtro é conferida contra uma referência
+// que ordena a janela e os desvios a cada amostra (mediana, MAD e
+// veredito de outlier iguais).
+//
+// Se o fluxo também tem os quadros de medição do firmware, cada medição
+// reconstruída é comparada com a gravada (instante, pulso e estado); o
+// resumo vai para a saída de erro, com a velocidade em relação ao tempo
+// real.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "distance.h"
+#include "edge_trace.h"
+#include "frame.h"
+#include "median_filter.h"
+#include "sensor.h"
+#include "sound.h"
+
+// Medições ainda sem par, por sensor
+#define REPLAY_QUEUE 64
+
+typedef struct
+{
+    uint32_t t_lo; // 32 bits baixos do instante, os que o trace carrega
+    uint32_t pulse_us;
+    uint8_t status;
+} replay_key_t;
+
+typedef struct
+{
+    replay_key_t item[REPLAY_QUEUE];
+    unsigned head;
+    unsigned count;
+} key_queue_t;
+
+typedef struct
+{
+    sensor_state_t sensors[SENSOR_MAX];
+    int8_t pin_sensor[32]; // sensor de cada pino, -1 se nenhum
+    uint32_t k_q8;
+    bool quiet;
+    median_filter_t filter[SENSOR_MAX];
+
+    // Referência do filtro: janela bruta de cada sensor
+    uint8_t window;
+    uint16_t k_deci;
+    int32_t ref_win[SENSOR_MAX][MEDIAN_MAX_WINDOW];
+    uint32_t ref_count[SENSOR_MAX];
+    uint32_t outliers;
+    uint32_t ref_diff;
+
+    // Distâncias válidas antes e depois do filtro
+    uint32_t valid;
+    double raw_sum, raw_sq;
+    double out_sum, out_sq;
+
+    key_queue_t recorded[SENSOR_MAX];
+    key_queue_t replayed[SENSOR_MAX];
+
+    uint32_t events;
+    uint32_t pings;
+    uint32_t results;
+    uint32_t matched;
+    uint32_t mismatched;
+    uint64_t t_first;
+    uint64_t t_last;
+} replay_t;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_i32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int32_t sorted_median(int32_t *v, int n)
+{
+    qsort(v, n, sizeof(int32_t), cmp_i32);
+    return (n & 1) ? v[n / 2] : (int32_t)(((int64_t)v[n / 2 - 1] + v[n / 2]) / 2);
+}
+
+// Confere a saída do filtro para a medição válida x contra a janela
+// ordenada a cada amostra
+static void filter_check(replay_t *r, int i, int32_t x, const measurement_t *m)
+{
+    uint8_t n = r->window;
+    r->ref_win[i][r->ref_count[i] % n] = x;
+    r->ref_count[i]++;
+    int ct = r->ref_count[i] < n ? (int)r->ref_count[i] : n;
+
+    int32_t tmp[MEDIAN_MAX_WINDOW];
+    memcpy(tmp, r->ref_win[i], ct * sizeof(int32_t));
+    int32_t median = sorted_median(tmp, ct);
+    for (int j = 0; j < ct; j++)
+        tmp[j] = abs(r->ref_win[i][j] - median);
+    int32_t mad = sorted_median(tmp, ct);
+    if (mad < MEDIAN_MAD_MIN_UM)
+        mad = MEDIAN_MAD_MIN_UM;
+    bool outlier = (int64_t)abs(x - median) * 100000 > (int64_t)r->k_deci * 14826 * mad;
+
+    r->outliers += m->status == MEAS_OUTLIER;
+    if ((int32_t)m->distance_um != median || (m->status == MEAS_OUTLIER) != outlier)
+        r->ref_diff++;
+}
+
+static void queue_push(key_queue_t *q, replay_key_t k)
+{
+    if (q->count == REPLAY_QUEUE)
+    {
+        q->head = (q->head + 1) % REPLAY_QUEUE;
+        q->count--;
+    }
+    q->item[(q->head + q->count) % REPLAY_QUEUE] = k;
+    q->count++;
+}
+
+// Casa as medições gravadas e reconstruídas de um sensor pela ordem no
+// tempo; a mais antiga sem par é descartada
+static void replay_match(replay_t *r, int sensor)
+{
+    key_queue_t *a = &r->recorded[sensor];
+    key_queue_t *b = &r->replayed[sensor];
+    while (a->count > 0 && b->count > 0)
+    {
+        replay_key_t *ka = &a->item[a->head];
+        replay_key_t *kb = &b->item[b->head];
+        int32_t dt = (int32_t)(ka->t_lo - kb->t_lo);
+        if (dt == 0)
+        {
+            if (ka->pulse_us == kb->pulse_us && ka->status == kb->status)
+                r->matched++;
+            else
+                r->mismatched++;
+        }
+        else if (r->matched + r->mismatched > 0 || dt > 0)
+        {
+            // Antes do primeiro par, medições gravadas antes do início do
+            // trace não contam como divergência
+            r->mismatched++;
+        }
+
+        if (dt <= 0)
+        {
+            a->head = (a->head + 1) % REPLAY_QUEUE;
+            a->count--;
+        }
+        if (dt >= 0)
+        {
+            b->head = (b->head + 1) % REPLAY_QUEUE;
+            b->count--;
+        }
+    }
+}
+
+static void replay_event(replay_t *r, const trace_record_t *ev)
+{
+    if (ev->pin >= sizeof(r->pin_sensor) || r->pin_sensor[ev->pin] < 0)
+        return;
+
+    int i = r->pin_sensor[ev->pin];
+    sensor_state_t *s = &r->sensors[i];
+    if (r->events++ == 0)
+        r->t_first = ev->t_us;
+    r->t_last = ev->t_us;
+
+    switch (ev->kind)
+    {
+    case TRACE_TRIG:
+        // O trace não traz o timeout; bordas tardias já viram TIMEOUT
+        sensor_trigger(s, ev->t_us, r->pings++, 0);
+        break;
+    case TRACE_RISE:
+        sensor_on_rise(s, ev->t_us);
+        break;
+    case TRACE_FALL:
+        sensor_on_fall(s, ev->t_us);
+        break;
+    case TRACE_TIMEOUT:
+        sensor_on_timeout(s);
+        break;
+    }
+
+    sensor_result_t result;
+    if (!sensor_take_result(s, &result))
+        return;
+
+    // Mesmo registro que acq_poll() monta, e o mesmo filtro de app_poll()
+    measurement_t m = {
+        .t_descida = result.ok ? result.t_descida : result.t_trigger,
+        .pulse_us = result.pulse_us,
+        .distance_um = result.ok ? distance_um(result.pulse_us, r->k_q8) : 0,
+        .sensor = (uint8_t)i,
+        .status = result.ok ? MEAS_OK : MEAS_TIMEOUT,
+    };
+    double raw = m.distance_um;
+    uint8_t raw_status = m.status;
+    median_filter_apply(&r->filter[i], &m);
+    if (result.ok && median_filter_enabled(&r->filter[i]))
+        filter_check(r, i, (int32_t)raw, &m);
+    if (result.ok)
+    {
+        r->valid++;
+        r->raw_sum += raw;
+        r->raw_sq += raw * raw;
+        r->out_sum += m.distance_um;
+        r->out_sq += (double)m.distance_um * m.distance_um;
+    }
+
+    r->results++;
+    if (!r->quiet)
+    {
+        printf("%llu,%d,%u,%u,%u\n", (unsigned long long)m.t_descida, i, (unsigned)m.pulse_us,
+               (unsigned)m.distance_um, (unsigned)m.status);
+    }
+
+    // O firmware grava a medição antes do filtro
+    queue_push(&r->replayed[i], (replay_key_t){(uint32_t)m.t_descida, m.pulse_us, raw_status});
+    replay_match(r, i);
+}
+
+int main(int argc, char **argv)
+{
+    static replay_t r;
+    r.k_q8 = DISTANCE_K_Q8_DEFAULT;
+
+    uint8_t window = 0;
+    uint16_t k_deci = MEDIAN_K_DECI_DEFAULT;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "qt:f:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'q':
+            r.quiet = true;
+            break;
+        case 't':
+            r.k_q8 = sound_k_q8((int32_t)(atof(optarg) * 10));
+            break;
+        case 'f':
+        {
+            char *comma;
+            window = (uint8_t)strtoul(optarg, &comma, 10);
+            if (*comma == ',')
+                k_deci = (uint16_t)(atof(comma + 1) * 10);
+            break;
+        }
+        default:
+            fprintf(stderr, "uso: hcsr04_replay [-q] [-t C] [-f janela[,k]] [arquivo]\n");
+            return 2;
+        }
+    }
+
+    FILE *in = stdin;
+    if (optind < argc && strcmp(argv[optind], "-") != 0)
+    {
+        in = fopen(argv[optind], "rb");
+        if (!in)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    const uint8_t pins[SENSOR_MAX][2] = SENSOR_PIN_TABLE;
+    memset(r.pin_sensor, -1, sizeof(r.pin_sensor));
+    for (int i = 0; i < SENSOR_MAX; i++)
+    {
+        sensor_init(&r.sensors[i]);
+        median_filter_init(&r.filter[i], window, k_deci);
+        r.window = r.filter[i].win.n;
+        r.k_deci = k_deci;
+        r.pin_sensor[pins[i][0]] = (int8_t)i;
+        r.pin_sensor[pins[i][1]] = (int8_t)i;
+    }
+
+    if (!r.quiet)
+        printf("timestamp_us,sensor,pulse_us,distance_um,status\n");
+
+    frame_reader_t reader;
+    frame_reader_init(&reader);
+    trace_decoder_t decoder;
+    trace_decoder_init(&decoder);
+    uint32_t bad_trace = 0;
+
+    double t0 = now_s();
+    static uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+    {
+        for (size_t b = 0; b < n; b++)
+        {
+            uint8_t payload[FRAME_MAX_PAYLOAD];
+            size_t len;
+            if (!frame_reader_feed(&reader, buf[b], payload, &len))
+                continue;
+
+            measurement_t m;
+            if (frame_unpack_measurement(payload, len, &m))
+            {
+                // Registros de oversampling agregam vários pings e não têm
+                // correspondente um a um na reprodução
+                if (m.sensor < SENSOR_MAX && m.shots == 1)
+                {
+                    queue_push(&r.recorded[m.sensor], (replay_key_t){(uint32_t)m.t_descida, m.pulse_us, m.status});
+                    replay_match(&r, m.sensor);
+                }
+                continue;
+            }
+
+            trace_record_t ev[FRAME_MAX_PAYLOAD];
+            int count = trace_unpack(&decoder, payload, len, ev, FRAME_MAX_PAYLOAD);
+            if (count < 0)
+            {
+                bad_trace++;
+                continue;
+            }
+            for (int e = 0; e < count; e++)
+                replay_event(&r, &ev[e]);
+        }
+    }
+    double dt = now_s() - t0;
+    double span = (r.t_last - r.t_first) / 1e6;
+
+    fprintf(stderr, "%u eventos, %u medições reconstruídas, %u iguais às gravadas, %u diferentes\n",
+            (unsigned)r.events, (unsigned)r.results, (unsigned)r.matched, (unsigned)r.mismatched);
+    fprintf(stderr, "%u quadros inválidos, %u de trace inválidos, %u eventos perdidos na placa\n",
+            (unsigned)reader.errors, (unsigned)bad_trace, (unsigned)decoder.lost);
+    if (r.valid > 0)
+    {
+        double raw_mean = r.raw_sum / r.valid, out_mean = r.out_sum / r.valid;
+        fprintf(stderr, "distância: média %.2f cm, desvio padrão %.2f cm bruto, %.2f cm filtrado\n",
+                out_mean / 10000, sqrt(fmax(r.raw_sq / r.valid - raw_mean * raw_mean, 0)) / 10000,
+                sqrt(fmax(r.out_sq / r.valid - out_mean * out_mean, 0)) / 10000);
+    }
+    if (r.window > 1)
+    {
+        fprintf(stderr, "filtro: janela %u, %u outliers, %u saídas diferentes da referência\n",
+                (unsigned)r.window, (unsigned)r.outliers, (unsigned)r.ref_diff);
+    }
+    fprintf(stderr, "%.1f s de registro em %.3f s (%.0fx o tempo real)\n", span, dt, dt > 0 ? span / dt : 0);
+    return r.mismatched == 0 && r.ref_diff == 0 ? 0 : 1;
+}
@@ -0,0 +1,707 @@
+// Alimenta a máquina de estados do sensor com eventos simulados lidos da
+// entrada padrão, um por linha (tempos em us):
+//
+//   trig <t>     dispara uma medição
+//   rise <t>     borda de subida do echo
+//   fall <t>     borda de descida do echo
+//   timeout      alarme de timeout
+//   pio <t> <orçamento> <subida> <alto>
+//                medição completa pelo modelo do programa hcsr04.pio
+//                (iterações de 2 ciclos a 125 MHz), entregue em <t>; o
+//                trigger é posto antes da subida como no firmware
+//
+// Após cada evento o resultado pendente (se houver) é consumido e impresso,
+// como o loop principal do firmware faz.
+//
+// Com "array" simula um conjunto de sensores em tempo virtual, passando pelo
+// escalonador de disparos, e imprime a vazão de cada um:
+//
+//   hcsr04_sim array <segundos> <intervalo_us> <guarda_us> <cm> [<cm> ...]
+//
+// Uma distância <= 0 simula um sensor sem echo. Com "burst" mede a taxa
+// alcançada por um sensor no modo burst para cada distância:
+//
+//   hcsr04_sim burst <guarda_us> <cm> [<cm> ...]
+//
+// Com "ring" estressa o anel de medições com um produtor e um consumidor em
+// threads separadas, como core1 e core0, e confere ordem e conteúdo:
+//
+//   hcsr04_sim ring <registros>
+//
+// Com "lines" passa a entrada padrão pelo anel de recepção e pelo montador
+// de linhas da entrada de comandos e imprime cada linha montada:
+//
+//   hcsr04_sim lines < comandos.txt
+//
+// Com "output" enche a fila de saída com uma linha por ms enquanto um
+// consumidor lento libera só <bytes> por ms no seu buffer (de até
+// SIM_OUT_BUFFER bytes, como o da CDC USB), e confere que cada linha
+// entregue chegou inteira e em ordem:
+//
+//   hcsr04_sim output <newest|oldest> <linhas> <bytes>
+//
+// Com "seqlock" uma thread faz o papel das IRQs, avançando o estado de um
+// sensor disparo após disparo com tempos que dependem do número do disparo,
+// enquanto outras leem o estado sem parar: uma com sensor_snapshot() e uma
+// direto dos campos, para mostrar o que o seqlock evita. Toda cópia
+// precisa ser coerente com um único disparo:
+//
+//   hcsr04_sim seqlock <disparos>
+//
+// Com "pio" passa pelo caminho das medições da PIO pulsos no limite do
+// orçamento, presos, sem echo e cedo demais, com latências de IRQ
+// variadas, e confere que todo disparo termina e libera o sensor:
+//
+//   hcsr04_sim pio
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "distance.h"
+#include "echo_pio_proto.h"
+#include "line_input.h"
+#include "meas_ring.h"
+#include "out_ring.h"
+#include "scheduler.h"
+#include "sensor.h"
+
+#define SIM_CLK_HZ 125000000u
+
+static int run_script(void)
+{
+    sensor_state_t s;
+    sensor_init(&s);
+    uint32_t ping = 0;
+
+    char line[64];
+    while (fgets(line, sizeof(line), stdin))
+    {
+        char ev[16];
+        unsigned long long t = 0;
+        uint32_t rejected[SENSOR_REJ_COUNT];
+        memcpy(rejected, s.rejected, sizeof(rejected));
+        unsigned budget = 0, rise_iter = 0, high_iters = 0;
+        int n = sscanf(line, "%15s %llu %u %u %u", ev, &t, &budget, &rise_iter, &high_iters);
+        if (n < 1 || ev[0] == '#')
+            continue;
+
+        bool moved;
+        if (strcmp(ev, "trig") == 0)
+            moved = sensor_trigger(&s, t, ping++, 0);
+        else if (strcmp(ev, "rise") == 0)
+            moved = sensor_on_rise(&s, t);
+        else if (strcmp(ev, "fall") == 0)
+            moved = sensor_on_fall(&s, t);
+        else if (strcmp(ev, "timeout") == 0)
+            moved = sensor_on_timeout(&s);
+        else if (strcmp(ev, "pio") == 0 && n == 5)
+        {
+            uint32_t words[2];
+            uint32_t width_cycles = 0;
+            echo_pio_model(budget, rise_iter, high_iters, words);
+            echo_pio_status_t st = echo_pio_decode(words[0], words[1], &width_cycles);
+            printf("  rx y=0x%08x x=0x%08x status=%d largura=%u ciclos\n",
+                   (unsigned)words[0], (unsigned)words[1], (int)st, (unsigned)width_cycles);
+
+            if (st == ECHO_PIO_OK)
+            {
+                // Trigger de 10 us, espera pela subida e largura, contadas
+                // para trás a partir de t
+                uint32_t width_us = echo_pio_cycles_to_us(width_cycles, SIM_CLK_HZ);
+                uint32_t rise_us = 10 + echo_pio_cycles_to_us(rise_iter * ECHO_PIO_CYCLES_PER_ITER, SIM_CLK_HZ);
+                if (rise_us < SENSOR_RISE_MIN_US)
+                    rise_us = SENSOR_RISE_MIN_US;
+                sensor_trigger(&s, t - width_us - rise_us, ping++, 0);
+                moved = sensor_on_pulse(&s, t, width_us);
+            }
+            else
+            {
+                uint32_t budget_us = echo_pio_cycles_to_us(budget * ECHO_PIO_CYCLES_PER_ITER, SIM_CLK_HZ);
+                sensor_trigger(&s, t - 10 - budget_us, ping++, 0);
+                moved = sensor_on_timeout(&s);
+            }
+        }
+        else
+        {
+            fprintf(stderr, "evento desconhecido: %s\n", ev);
+            continue;
+        }
+
+        const char *why = "";
+        for (int r = 0; r < SENSOR_REJ_COUNT; r++)
+            if (s.rejected[r] != rejected[r])
+                why = sensor_reject_name((sensor_reject_t)r);
+        if (moved)
+            printf("%-8s -> %s\n", ev, sensor_phase_name(s.phase));
+        else
+            printf("%-8s -> %s (ignorado%s%s)\n", ev, sensor_phase_name(s.phase), why[0] ? ": " : "", why);
+
+        sensor_result_t r;
+        if (sensor_take_result(&s, &r))
+        {
+            if (r.ok)
+            {
+                char cm[DISTANCE_CM_STR_MAX];
+                distance_format_cm(cm, distance_um(r.pulse_us, DISTANCE_K_Q8_DEFAULT));
+                printf("  pulso %u us = %s cm\n", (unsigned)r.pulse_us, cm);
+            }
+            else
+            {
+                printf("  Falha\n");
+            }
+        }
+    }
+    return 0;
+}
+
+// Atraso típico entre o fim do trigger e a subida do echo
+#define SIM_RISE_DELAY_US 450
+// Período do loop principal simulado
+#define SIM_STEP_US 10
+
+typedef struct
+{
+    uint64_t rise_at;
+    uint64_t fall_at;
+    uint64_t timeout_at;
+} sim_echo_t;
+
+// Roda o escalonador contra sensores simulados por duration_us de tempo
+// virtual. width_us[i] == 0 simula um sensor sem echo.
+static void sim_array(scheduler_t *sched, uint8_t count, const uint32_t *width_us, uint64_t duration_us)
+{
+    sensor_state_t sensors[SENSOR_MAX];
+    sim_echo_t echo[SENSOR_MAX];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        sensor_init(&sensors[i]);
+        echo[i] = (sim_echo_t){UINT64_MAX, UINT64_MAX, UINT64_MAX};
+    }
+    uint32_t ping = 0;
+
+    for (uint64_t now = 0; now < duration_us; now += SIM_STEP_US)
+    {
+        // Bordas e alarmes que aconteceram até agora
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (now >= echo[i].rise_at)
+            {
+                sensor_on_rise(&sensors[i], echo[i].rise_at);
+                echo[i].rise_at = UINT64_MAX;
+            }
+            if (now >= echo[i].fall_at)
+            {
+                sensor_on_fall(&sensors[i], echo[i].fall_at);
+                echo[i].fall_at = UINT64_MAX;
+            }
+            if (now >= echo[i].timeout_at)
+            {
+                sensor_on_timeout(&sensors[i]);
+                echo[i].timeout_at = UINT64_MAX;
+            }
+        }
+
+        int idx = sched_next(sched, now);
+        if (idx >= 0 && sensor_trigger(&sensors[idx], now, ping++, 0))
+        {
+            echo[idx].timeout_at = now + sensor_echo_timeout_us(SENSOR_MAX_RANGE_MM);
+            if (width_us[idx] > 0)
+            {
+                echo[idx].rise_at = now + SIM_RISE_DELAY_US;
+                echo[idx].fall_at = echo[idx].rise_at + width_us[idx];
+            }
+        }
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            sensor_result_t r;
+            if (sensor_take_result(&sensors[i], &r))
+            {
+                echo[i].timeout_at = UINT64_MAX;
+                sched_done(sched, i, r.ok, now);
+            }
+        }
+    }
+}
+
+static uint32_t sim_width_us(const char *cm_arg)
+{
+    double cm = atof(cm_arg);
+    return cm > 0 ? (uint32_t)(cm * 2.0 / 0.0343) : 0;
+}
+
+static int run_array(int argc, char **argv)
+{
+    if (argc < 4 || argc - 3 > SENSOR_MAX)
+    {
+        fprintf(stderr, "uso: hcsr04_sim array <segundos> <intervalo_us> <guarda_us> <cm>...\n");
+        return 1;
+    }
+
+    uint64_t duration_us = (uint64_t)(atof(argv[0]) * 1e6);
+    uint32_t interval_us = (uint32_t)strtoul(argv[1], NULL, 10);
+    uint32_t guard_us = (uint32_t)strtoul(argv[2], NULL, 10);
+    uint8_t count = (uint8_t)(argc - 3);
+
+    uint32_t width_us[SENSOR_MAX];
+    for (uint8_t i = 0; i < count; i++)
+        width_us[i] = sim_width_us(argv[3 + i]);
+
+    scheduler_t sched;
+    sched_init(&sched, count, interval_us, guard_us);
+    sim_array(&sched, count, width_us, duration_us);
+
+    uint32_t total_mhz = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t rate = sched_rate_mhz(&sched, i, duration_us);
+        total_mhz += rate;
+        printf("sensor %u: %u ok, %u falhas, %u.%03u leituras/s\n", (unsigned)i,
+               (unsigned)sched.ok[i], (unsigned)sched.failed[i], (unsigned)(rate / 1000), (unsigned)(rate % 1000));
+    }
+    printf("total: %u.%03u leituras/s\n", (unsigned)(total_mhz / 1000), (unsigned)(total_mhz % 1000));
+    return 0;
+}
+
+// Modo burst de um sensor para cada distância dada
+static int run_burst(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "uso: hcsr04_sim burst <guarda_us> <cm>...\n");
+        return 1;
+    }
+
+    uint32_t guard_us = (uint32_t)strtoul(argv[0], NULL, 10);
+    const uint64_t duration_us = 10000000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        uint32_t width_us = sim_width_us(argv[i]);
+        scheduler_t sched;
+        sched_init(&sched, 1, 0, guard_us);
+        sim_array(&sched, 1, &width_us, duration_us);
+
+        uint32_t ok_rate = sched_rate_mhz(&sched, 0, duration_us);
+        uint32_t pings = sched.ok[0] + sched.failed[0];
+        uint32_t ping_rate = (uint32_t)((uint64_t)pings * 1000000000ull / duration_us);
+        printf("%8s cm: %u.%03u leituras/s (%u.%03u pings/s)\n", argv[i],
+               (unsigned)(ok_rate / 1000), (unsigned)(ok_rate % 1000),
+               (unsigned)(ping_rate / 1000), (unsigned)(ping_rate % 1000));
+    }
+    return 0;
+}
+
+typedef struct
+{
+    meas_ring_t ring;
+    uint32_t total;
+    atomic_bool done;
+} ring_stress_t;
+
+static void *ring_producer(void *arg)
+{
+    ring_stress_t *st = arg;
+    for (uint32_t seq = 0; seq < st->total; seq++)
+    {
+        measurement_t m = {
+            .t_descida = (uint64_t)seq << 20,
+            .seq = seq,
+            .pulse_us = seq * 7u,
+            .sensor = (uint8_t)(seq % SENSOR_MAX),
+            .status = MEAS_OK,
+        };
+        // Insiste com o anel cheio para que todo registro atravesse a fila
+        while (!meas_ring_push(&st->ring, &m))
+            sched_yield();
+    }
+    atomic_store(&st->done, true);
+    return NULL;
+}
+
+static int run_ring(int argc, char **argv)
+{
+    static ring_stress_t st;
+    st.total = argc > 0 ? (uint32_t)strtoul(argv[0], NULL, 10) : 1000000u;
+    meas_ring_init(&st.ring);
+    atomic_init(&st.done, false);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, ring_producer, &st);
+
+    uint32_t popped = 0;
+    uint32_t errors = 0;
+    int64_t last = -1;
+    for (;;)
+    {
+        bool finished = atomic_load(&st.done);
+        measurement_t m;
+        while (meas_ring_pop(&st.ring, &m))
+        {
+            popped++;
+            if ((int64_t)m.seq <= last || m.pulse_us != m.seq * 7u ||
+                m.t_descida != (uint64_t)m.seq << 20 || m.sensor != m.seq % SENSOR_MAX)
+                errors++;
+            last = m.seq;
+        }
+        if (finished)
+            break;
+        sched_yield();
+    }
+    pthread_join(producer, NULL);
+
+    uint32_t drops = atomic_load(&st.ring.drops);
+    printf("%u registros: %u lidos, %u vezes com anel cheio, ocupação máx %u/%u, %u erros\n",
+           (unsigned)st.total, (unsigned)popped, (unsigned)drops,
+           (unsigned)atomic_load(&st.ring.high_water), (unsigned)MEAS_RING_SIZE, (unsigned)errors);
+    return (errors == 0 && popped == st.total) ? 0 : 1;
+}
+
+// Tempos do disparo p: as duas metades de 32 bits mudam a cada disparo
+#define TORTURE_T(p) ((uint64_t)(p) * 0x100000001ull)
+
+typedef struct
+{
+    sensor_state_t s;
+    uint32_t total;
+    atomic_bool done;
+} torture_t;
+
+typedef struct
+{
+    torture_t *st;
+    bool direct; // lê os campos sem o seqlock
+    uint64_t reads;
+    uint64_t retries;
+    uint64_t torn;
+} torture_reader_t;
+
+static void *torture_writer(void *arg)
+{
+    torture_t *st = arg;
+    for (uint32_t p = 1; p <= st->total; p++)
+    {
+        uint64_t t = TORTURE_T(p);
+        sensor_trigger(&st->s, t, p, 0);
+        sensor_on_rise(&st->s, t + SENSOR_RISE_MIN_US + p);
+        if (p % 4 == 0)
+            sensor_on_timeout(&st->s);
+        else
+            sensor_on_fall(&st->s, t + 3ull * p);
+        sensor_result_t r;
+        sensor_take_result(&st->s, &r);
+    }
+    atomic_store(&st->done, true);
+    return NULL;
+}
+
+// Confere que a cópia é um estado possível de um único disparo
+static bool torture_consistent(const sensor_snapshot_t *c)
+{
+    uint64_t p = c->ping;
+    if (p == 0)
+        return c->phase == SENSOR_IDLE && c->t_trigger == 0 && c->t_subida == 0 && c->t_descida == 0;
+    if (c->t_trigger != TORTURE_T(p))
+        return false;
+
+    bool rose = c->t_subida == TORTURE_T(p) + SENSOR_RISE_MIN_US + p;
+    bool fell = c->t_descida == TORTURE_T(p) + 3 * p;
+    switch (c->phase)
+    {
+    case SENSOR_TRIGGERED:
+        return c->t_subida == 0 && c->t_descida == 0;
+    case SENSOR_ECHO_HIGH:
+    case SENSOR_TIMEOUT:
+        return rose && c->t_descida == 0 && (c->phase != SENSOR_TIMEOUT || p % 4 == 0);
+    case SENSOR_DONE:
+        return rose && fell;
+    case SENSOR_IDLE:
+        return rose && (p % 4 == 0 ? c->t_descida == 0 : fell);
+    }
+    return false;
+}
+
+static void *torture_reader(void *arg)
+{
+    torture_reader_t *rd = arg;
+    const volatile sensor_state_t *v = &rd->st->s;
+    while (!atomic_load_explicit(&rd->st->done, memory_order_relaxed))
+    {
+        sensor_snapshot_t c;
+        if (rd->direct)
+        {
+            c.ping = v->ping;
+            c.phase = v->phase;
+            c.t_trigger = v->t_trigger;
+            c.t_subida = v->t_subida;
+            c.t_descida = v->t_descida;
+        }
+        else
+        {
+            rd->retries += sensor_snapshot(&rd->st->s, &c);
+        }
+        rd->reads++;
+        if (!torture_consistent(&c))
+            rd->torn++;
+    }
+    return NULL;
+}
+
+static int run_seqlock(int argc, char **argv)
+{
+    static torture_t st;
+    st.total = argc > 0 ? (uint32_t)strtoul(argv[0], NULL, 10) : 10000000u;
+    sensor_init(&st.s);
+    atomic_init(&st.done, false);
+
+    torture_reader_t readers[2] = {{.st = &st, .direct = false}, {.st = &st, .direct = true}};
+    pthread_t threads[2];
+    for (int i = 0; i < 2; i++)
+        pthread_create(&threads[i], NULL, torture_reader, &readers[i]);
+    torture_writer(&st);
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], NULL);
+
+    printf("%u disparos\n", (unsigned)st.total);
+    printf("seqlock: %llu leituras, %llu repetidas, %llu incoerentes\n", (unsigned long long)readers[0].reads,
+           (unsigned long long)readers[0].retries, (unsigned long long)readers[0].torn);
+    printf("direto:  %llu leituras, %llu incoerentes\n", (unsigned long long)readers[1].reads,
+           (unsigned long long)readers[1].torn);
+    return readers[0].torn == 0 && readers[0].reads > 0 ? 0 : 1;
+}
+
+// Uma medição da PIO: trigger em t_trigger, o programa começa a contar
+// depois dos 10 us do trigger e a IRQ entrega o resultado latency_us depois
+// do fim. Retorna a fase em que o disparo terminou.
+static sensor_phase_t pio_case(sensor_state_t *s, uint64_t t_trigger, uint32_t window_us, uint32_t budget,
+                               uint32_t rise_iter, uint32_t high_iters, uint32_t latency_us, uint32_t *pulse_us)
+{
+    static uint32_t ping;
+    uint32_t words[2];
+    uint32_t width_cycles = 0;
+    echo_pio_model(budget, rise_iter, high_iters, words);
+    echo_pio_status_t st = echo_pio_decode(words[0], words[1], &width_cycles);
+
+    sensor_trigger(s, t_trigger, ping++, window_us);
+    // Iterações gastas até o programa parar
+    uint32_t iters = budget - words[1];
+    uint64_t t_end = t_trigger + 10 + echo_pio_cycles_to_us(iters * ECHO_PIO_CYCLES_PER_ITER, SIM_CLK_HZ);
+    if (st == ECHO_PIO_OK)
+        sensor_on_pulse(s, t_end + latency_us, echo_pio_cycles_to_us(width_cycles, SIM_CLK_HZ));
+    else
+        sensor_on_timeout(s);
+
+    sensor_phase_t phase = s->phase;
+    sensor_result_t r;
+    *pulse_us = 0;
+    if (sensor_take_result(s, &r))
+        *pulse_us = r.pulse_us;
+    return phase;
+}
+
+static int run_pio(void)
+{
+    static const uint32_t latencies_us[] = {0, 5, 50, 500};
+    uint32_t timeout_us = sensor_echo_timeout_us(SENSOR_MAX_RANGE_MM);
+    uint32_t budget = echo_pio_budget(timeout_us, SIM_CLK_HZ);
+    uint32_t rise_iter = 450 * (SIM_CLK_HZ / 1000000u) / ECHO_PIO_CYCLES_PER_ITER;
+
+    // O pulso mais longo que ainda desce dentro do orçamento
+    uint32_t high_max = budget - rise_iter - 2;
+    for (;;)
+    {
+        uint32_t words[2], width_cycles;
+        echo_pio_model(budget, rise_iter, high_max + 1, words);
+        if (echo_pio_decode(words[0], words[1], &width_cycles) != ECHO_PIO_OK)
+            break;
+        high_max++;
+    }
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t rise_iter;
+        uint32_t high_iters;
+        sensor_phase_t expect;
+        bool any_end; // basta terminar
+    } pio_case_t;
+    // A subida cedo só é vista com pouca latência: a IRQ atrasa as duas
+    // bordas reconstruídas
+    const pio_case_t cases[] = {
+        {"limite-1", rise_iter, high_max - 1, SENSOR_DONE, false},
+        {"limite", rise_iter, high_max, SENSOR_DONE, false},
+        {"limite+1", rise_iter, high_max + 1, SENSOR_TIMEOUT, false},
+        {"preso", rise_iter, UINT32_MAX, SENSOR_TIMEOUT, false},
+        {"sem echo", UINT32_MAX, 0, SENSOR_TIMEOUT, false},
+        {"cedo", 0, 1000, SENSOR_TIMEOUT, true},
+    };
+
+    sensor_state_t s;
+    sensor_init(&s);
+    uint64_t t = 0;
+    uint32_t errors = 0;
+    printf("orçamento %u iterações (%u us)\n", (unsigned)budget, (unsigned)timeout_us);
+    // Janela 0 é a do firmware; a do timeout mostra que um pulso rejeitado
+    // também encerra o disparo
+    for (int w = 0; w < 2; w++)
+    {
+        uint32_t window_us = w ? timeout_us : 0;
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+        {
+            for (size_t l = 0; l < sizeof(latencies_us) / sizeof(latencies_us[0]); l++)
+            {
+                t += 100000;
+                uint32_t pulse_us;
+                sensor_phase_t phase = pio_case(&s, t, window_us, budget, cases[c].rise_iter, cases[c].high_iters,
+                                                latencies_us[l], &pulse_us);
+                // Com janela um pulso no limite pode virar timeout, mas o
+                // sensor nunca fica esperando
+                bool ok = s.phase == SENSOR_IDLE &&
+                          (phase == cases[c].expect || cases[c].any_end ||
+                           (window_us > 0 && phase == SENSOR_TIMEOUT));
+                printf("janela %-6u %-9s latência %3u us -> %-9s pulso %u us%s\n", (unsigned)window_us,
+                       cases[c].name, (unsigned)latencies_us[l], sensor_phase_name(phase), (unsigned)pulse_us,
+                       ok ? "" : "  ERRO");
+                if (!ok)
+                    errors++;
+            }
+        }
+    }
+    printf("%u erros\n", (unsigned)errors);
+    return errors == 0 ? 0 : 1;
+}
+
+static int run_lines(void)
+{
+    line_rx_t rx;
+    line_asm_t line;
+    line_rx_init(&rx);
+    line_asm_init(&line);
+
+    // Entrega os bytes em rajadas do tamanho do anel, como a IRQ faria
+    uint32_t t = 0;
+    uint32_t lines = 0;
+    int ch = 0;
+    while (ch != EOF)
+    {
+        while ((ch = getchar()) != EOF)
+        {
+            if (!line_rx_push(&rx, (uint8_t)ch, t++))
+            {
+                ungetc(ch, stdin);
+                break;
+            }
+        }
+
+        uint8_t c;
+        uint32_t t_rx;
+        while (line_rx_pop(&rx, &c, &t_rx))
+        {
+            if (line_asm_feed(&line, c, t_rx))
+            {
+                printf("[%u] '%s'\n", (unsigned)line.t_end_us, line.buf);
+                lines++;
+            }
+        }
+    }
+    printf("%u linhas, %u bytes perdidos\n", (unsigned)lines, (unsigned)atomic_load(&rx.overruns));
+    return 0;
+}
+
+typedef struct
+{
+    char partial[64]; // linha ainda incompleta entre chamadas
+    size_t partial_len;
+    int64_t last_seq;
+    uint32_t lines;
+    uint32_t errors;
+} sim_consumer_t;
+
+static void sim_consumer_write(const uint8_t *data, size_t len, void *ctx)
+{
+    sim_consumer_t *c = ctx;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (c->partial_len >= sizeof(c->partial))
+        {
+            c->errors++;
+            c->partial_len = 0;
+        }
+        c->partial[c->partial_len++] = (char)data[i];
+        if (data[i] != '\n')
+            continue;
+
+        unsigned long seq, check;
+        c->partial[c->partial_len - 1] = '\0';
+        if (sscanf(c->partial, "linha %lu check %lu", &seq, &check) != 2 || check != seq * 3 ||
+            (int64_t)seq <= c->last_seq)
+            c->errors++;
+        c->last_seq = (int64_t)seq;
+        c->lines++;
+        c->partial_len = 0;
+    }
+}
+
+#define SIM_OUT_BUFFER 256
+
+static int run_output(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "uso: hcsr04_sim output <newest|oldest> <linhas> <bytes>\n");
+        return 2;
+    }
+
+    static out_ring_t ring;
+    out_ring_init(&ring, strcmp(argv[0], "oldest") == 0 ? OUT_DROP_OLDEST : OUT_DROP_NEWEST);
+    uint32_t total = (uint32_t)strtoul(argv[1], NULL, 10);
+    size_t per_ms = (size_t)strtoul(argv[2], NULL, 10);
+
+    sim_consumer_t consumer = {.last_seq = -1};
+    size_t room = 0; // espaço livre no buffer do consumidor
+    uint32_t t_us = 0;
+    for (uint32_t seq = 0; seq < total; seq++, t_us += 1000)
+    {
+        char line[48];
+        int n = snprintf(line, sizeof(line), "linha %lu check %lu\n", (unsigned long)seq,
+                         (unsigned long)seq * 3);
+        out_ring_write(&ring, line, (size_t)n, t_us);
+        room = room + per_ms > SIM_OUT_BUFFER ? SIM_OUT_BUFFER : room + per_ms;
+        room -= out_ring_drain(&ring, room, sim_consumer_write, &consumer, t_us);
+    }
+    // O consumidor volta a ler tudo no fim
+    while (out_ring_drain(&ring, OUT_RING_SIZE, sim_consumer_write, &consumer, t_us) > 0)
+    {
+    }
+
+    const out_stats_t *st = &ring.stats;
+    uint32_t dropped = st->records_dropped;
+    printf("%u linhas: %u entregues, %u descartadas (%u bytes), %u/%u bytes enfileirados/enviados, "
+           "ocupação máx %u/%u, latência máx %u us, %u erros\n",
+           (unsigned)total, (unsigned)consumer.lines, (unsigned)dropped, (unsigned)st->bytes_dropped,
+           (unsigned)st->bytes_queued, (unsigned)st->bytes_flushed, (unsigned)st->high_water,
+           (unsigned)OUT_RING_SIZE, (unsigned)st->max_latency_us, (unsigned)consumer.errors);
+    return (consumer.errors == 0 && consumer.partial_len == 0 && consumer.lines + dropped == total) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "output") == 0)
+        return run_output(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "lines") == 0)
+        return run_lines();
+    if (argc > 1 && strcmp(argv[1], "seqlock") == 0)
+        return run_seqlock(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "pio") == 0)
+        return run_pio();
+    if (argc > 1 && strcmp(argv[1], "ring") == 0)
+        return run_ring(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "burst") == 0)
+        return run_burst(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "array") == 0)
+        return run_array(argc - 2, argv + 2);
+    return run_script();
+}
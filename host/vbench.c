@@ -0,0 +1,262 @@
+// Benchmark em tempo virtual do laço de medição: roda a aplicação do
+// firmware (acq_poll()/app_poll(), como em main()) contra o modelo do
+// HC-SR04 do hal_sim.c em cenários fixos e imprime os resultados em JSON.
+//
+//   hcsr04_vbench [cenário ...]
+//
+// Sem argumentos roda todos. Por cenário:
+//
+//   samples_per_s        medições válidas por segundo virtual
+//   first_result_us      do 'start' à chegada da primeira medição válida
+//   fail_latency_*_us    do trigger de uma medição falha à chegada do
+//                        seu registro na saída
+//   busy_fraction        fração das voltas de FW_SIM_STEP_US em que os
+//                        loops ou as IRQs tiveram trabalho
+//   mean_cm, stddev_cm   das medições válidas
+//   output_bytes_per_s   bytes da saída binária por segundo virtual
+//   ignored_triggers     triggers que o modelo ignorou por estar ocupado
+//   interlock_releases   vezes que o pino do intertravamento caiu depois
+//                        de ativado
+//
+// Cenários com checks saem com erro (status 1) se VBENCH_NO_IGNORED e algum
+// trigger foi ignorado, ou se VBENCH_HOLD_NEAR (alvo sempre perto) e o pino
+// do intertravamento caiu.
+//
+// Tudo é determinístico (relógio virtual e ruído com semente fixa), então
+// dois resultados diferentes indicam mudança de comportamento.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "acq.h"
+#include "app.h"
+#include "config.h"
+#include "frame.h"
+#include "hal_sim.h"
+#include "threshold.h"
+
+#define VBENCH_STEP_US 10
+#define VBENCH_SEED 12345
+#define VBENCH_MAX_COMMANDS 4
+
+typedef struct
+{
+    const char *name;
+    int32_t distance_mm; // < 0 = sem alvo
+    uint32_t noise_us;
+    uint32_t dropout_pct;
+    uint32_t stuck_pct;
+    uint32_t seconds;
+    const char *commands[VBENCH_MAX_COMMANDS];
+    uint32_t checks;
+} vbench_scenario_t;
+
+#define VBENCH_NO_IGNORED (1u << 0)
+#define VBENCH_HOLD_NEAR (1u << 1)
+
+static const vbench_scenario_t scenarios[] = {
+    {"near", 200, 0, 0, 0, 10, {"burst 5000"}, 0},
+    {"far", 3500, 0, 0, 0, 10, {"burst 5000"}, 0},
+    {"out_of_range", -1, 0, 0, 0, 10, {"burst 5000"}, 0},
+    {"dropout_10pct", 1000, 0, 10, 0, 10, {"burst 5000"}, 0},
+    {"noisy_edges", 1000, 50, 0, 0, 10, {"burst 5000"}, 0},
+    {"periodic_50hz", 1000, 0, 0, 0, 10, {"rate 50"}, 0},
+    {"periodic_50hz_dropout_10pct", 1000, 0, 10, 0, 10, {"rate 50"}, 0},
+    {"periodic_50hz_deadband_1mm", 1000, 0, 0, 0, 10, {"rate 50", "deadband 1 1000"}, 0},
+    {"noisy_edges_avg8", 1000, 50, 0, 0, 10, {"burst 5000", "avg 8"}, 0},
+    {"noisy_edges_avg8_dropout_10pct", 1000, 50, 10, 0, 10, {"burst 5000", "avg 8"}, 0},
+    // 30% dos echoes presos em alto por 200 ms: o burst só redispara com o
+    // echo baixo, sem triggers perdidos num sensor ocupado
+    {"burst_stuck_30pct", 1000, 0, 0, 30, 10, {"burst 5000"}, VBENCH_NO_IGNORED},
+    // Alvo parado dentro do limiar perto com 30% de pings perdidos: só 8
+    // timeouts seguidos (p = 7e-5 por ping) soltariam o pino
+    {"interlock_near_dropout_30pct", 200, 0, 30, 0, 10, {"rate 50", "threshold 300 400 8"}, VBENCH_HOLD_NEAR},
+};
+
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+typedef struct
+{
+    frame_reader_t reader;
+    uint64_t t_start;
+    uint32_t ok;
+    uint32_t failed;
+    int64_t first_result_us; // -1 até a primeira medição válida
+    uint64_t fail_latency_sum;
+    uint32_t fail_latency_max;
+    double sum_cm;
+    double sum_sq_cm;
+    uint64_t bytes;
+    uint32_t ignored;
+    bool interlock_on;
+    uint32_t interlock_releases;
+} vbench_run_t;
+
+// Saída binária da aplicação, decodificada como o host faria
+static void vbench_collect(const uint8_t *data, size_t len, void *ctx)
+{
+    vbench_run_t *run = ctx;
+    uint64_t now = hal_time_us();
+    run->bytes += len;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        size_t n;
+        measurement_t m;
+        if (!frame_reader_feed(&run->reader, data[i], payload, &n) || !frame_unpack_measurement(payload, n, &m))
+            continue;
+
+        if (m.status == MEAS_OK)
+        {
+            if (run->first_result_us < 0)
+                run->first_result_us = (int64_t)(now - run->t_start);
+            double cm = m.distance_um / 10000.0;
+            run->ok++;
+            run->sum_cm += cm;
+            run->sum_sq_cm += cm * cm;
+        }
+        else
+        {
+            uint32_t latency = (uint32_t)(now - m.t_descida);
+            run->failed++;
+            run->fail_latency_sum += latency;
+            if (latency > run->fail_latency_max)
+                run->fail_latency_max = latency;
+        }
+    }
+}
+
+static bool vbench_run(const vbench_scenario_t *sc, FILE *json, bool first)
+{
+    static vbench_run_t run;
+    memset(&run, 0, sizeof(run));
+    frame_reader_init(&run.reader);
+    run.first_result_us = -1;
+
+    hal_sim_reset(VBENCH_SEED);
+    hal_sim_set_output(vbench_collect, &run);
+    const uint8_t pins[SENSOR_MAX][2] = SENSOR_PIN_TABLE;
+    hal_sim_sensor_t *models[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        hal_sim_sensor_t *s = hal_sim_add_sensor(pins[i][0], pins[i][1]);
+        s->distance_mm = sc->distance_mm;
+        s->noise_us = sc->noise_us;
+        s->dropout_pct = sc->dropout_pct;
+        s->stuck_pct = sc->stuck_pct;
+        models[i] = s;
+    }
+
+    acq_init();
+    acq_setup();
+    app_init();
+
+    char line[LINE_MAX_LEN + 2];
+    hal_sim_input("format bin\n");
+    for (int i = 0; i < VBENCH_MAX_COMMANDS && sc->commands[i]; i++)
+    {
+        snprintf(line, sizeof(line), "%s\n", sc->commands[i]);
+        hal_sim_input(line);
+    }
+    hal_sim_input("start\n");
+    run.t_start = hal_time_us();
+
+    uint64_t end = run.t_start + sc->seconds * 1000000ull;
+    uint64_t slots = 0;
+    uint64_t busy = 0;
+    while (hal_time_us() < end)
+    {
+        uint32_t irqs = hal_sim_irq_count();
+        bool work = acq_poll();
+        work |= app_poll();
+        hal_sim_advance(VBENCH_STEP_US);
+        if (work || hal_sim_irq_count() != irqs)
+            busy++;
+        slots++;
+
+        bool pin = (hal_gpio_get_all() >> THRESHOLD_OUT_PIN) & 1u;
+        if (run.interlock_on && !pin)
+            run.interlock_releases++;
+        run.interlock_on = pin;
+    }
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+        run.ignored += models[i]->stats.ignored;
+
+    double seconds = (end - run.t_start) / 1e6;
+    double mean = run.ok ? run.sum_cm / run.ok : 0;
+    double var = run.ok ? run.sum_sq_cm / run.ok - mean * mean : 0;
+
+    fprintf(json, "%s\n    {\"name\": \"%s\", \"seconds\": %u, \"samples\": %u, \"failures\": %u, ",
+            first ? "" : ",", sc->name, (unsigned)sc->seconds, (unsigned)run.ok, (unsigned)run.failed);
+    fprintf(json, "\"samples_per_s\": %.3f, \"first_result_us\": ", run.ok / seconds);
+    if (run.first_result_us < 0)
+        fprintf(json, "null");
+    else
+        fprintf(json, "%lld", (long long)run.first_result_us);
+    fprintf(json, ", \"fail_latency_avg_us\": %llu, \"fail_latency_max_us\": %u, ",
+            run.failed ? (unsigned long long)(run.fail_latency_sum / run.failed) : 0ull,
+            (unsigned)run.fail_latency_max);
+    fprintf(json, "\"busy_fraction\": %.6f, \"mean_cm\": %.3f, \"stddev_cm\": %.3f, ", (double)busy / slots, mean,
+            var > 0 ? sqrt(var) : 0.0);
+    fprintf(json, "\"output_bytes_per_s\": %.1f, \"ignored_triggers\": %u, \"interlock_releases\": %u}",
+            run.bytes / seconds, (unsigned)run.ignored, (unsigned)run.interlock_releases);
+    if ((sc->checks & VBENCH_NO_IGNORED) && run.ignored > 0)
+    {
+        fprintf(stderr, "%s: %u triggers ignorados pelo sensor ocupado\n", sc->name, (unsigned)run.ignored);
+        return false;
+    }
+    if ((sc->checks & VBENCH_HOLD_NEAR) && run.interlock_releases > 0)
+    {
+        fprintf(stderr, "%s: intertravamento solto com o alvo perto\n", sc->name);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    // Banner e respostas vão pela fila de saída (e contam em
+    // output_bytes_per_s); o stdout fica só para um printf que reste. O JSON
+    // sai pelo descritor original da saída padrão
+    FILE *json = fdopen(dup(STDOUT_FILENO), "w");
+    if (json == NULL || freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("hcsr04_vbench");
+        return 1;
+    }
+
+    fprintf(json, "{\"step_us\": %d, \"seed\": %d, \"sensors\": %d, \"scenarios\": [", VBENCH_STEP_US,
+            VBENCH_SEED, SENSOR_COUNT);
+    bool first = true;
+    int status = 0;
+    for (int a = 1; a < argc; a++)
+    {
+        size_t i = 0;
+        while (i < SCENARIO_COUNT && strcmp(scenarios[i].name, argv[a]) != 0)
+            i++;
+        if (i == SCENARIO_COUNT)
+        {
+            fprintf(stderr, "cenário desconhecido: %s\n", argv[a]);
+            status = 2;
+        }
+    }
+    for (size_t i = 0; i < SCENARIO_COUNT && status != 2; i++)
+    {
+        bool selected = argc == 1;
+        for (int a = 1; a < argc; a++)
+            selected |= strcmp(scenarios[i].name, argv[a]) == 0;
+        if (!selected)
+            continue;
+
+        if (!vbench_run(&scenarios[i], json, first))
+            status = 1;
+        first = false;
+    }
+    fprintf(json, "\n]}\n");
+    fclose(json);
+    return status;
+}
@@ -0,0 +1,691 @@
+#include "acq.h"
+
+#include <string.h>
+
+#include "config.h"
+#include "distance.h"
+#include "edge_trace.h"
+#include "hal.h"
+#include "sensor.h"
+#include "threshold.h"
+
+#if HCSR04_USE_PIO
+#include "echo_pio.h"
+#endif
+
+// Handler cru das bordas do echo; com a PIO não há IRQ de GPIO
+#if HCSR04_RAW_GPIO_IRQ && !HCSR04_USE_PIO
+#define ACQ_RAW_IRQ 1
+#else
+#define ACQ_RAW_IRQ 0
+#endif
+
+// Pinos de cada sensor
+typedef struct
+{
+    unsigned int trig;
+    unsigned int echo;
+} sensor_pins_t;
+
+static const sensor_pins_t sensor_pins[SENSOR_MAX] = SENSOR_PIN_TABLE;
+
+// Estado global dos sensores (necessário para callbacks de IRQ)
+static sensor_state_t sensors[SENSOR_COUNT];
+
+static scheduler_t sched;
+static meas_ring_t ring;
+
+// Comandos do core0 para o core1
+static volatile bool running;
+static volatile bool reset_stats;
+static volatile uint32_t max_range_mm;
+static volatile uint32_t echo_timeout_us;
+static volatile uint32_t interval_us;
+static volatile bool burst;
+static volatile uint32_t burst_guard_us;
+static volatile bool timing_changed;
+static volatile uint32_t sound_k;
+static volatile uint8_t avg_shots;
+
+// Id do próximo disparo, único entre os sensores. Vai para o campo seq de
+// cada registro, para que o host detecte perdas e duplicatas.
+static uint32_t ping_seq;
+
+// Oversampling: pings do grupo corrente de cada sensor, somados até virar
+// um único registro
+typedef struct
+{
+    uint8_t shots; // tamanho do grupo, fixado no primeiro ping
+    uint8_t done;
+    uint8_t valid;
+    uint32_t first_ping;
+    uint64_t t_descida; // do último ping válido
+    uint64_t pulse_sum;
+    uint64_t um_sum;
+    uint32_t min_um;
+    uint32_t max_um;
+} avg_acc_t;
+
+static avg_acc_t avg_acc[SENSOR_COUNT];
+
+static acq_jitter_t jitter[SENSOR_COUNT];
+
+static void jitter_add(acq_jitter_t *j, uint32_t pulse_us)
+{
+    if (j->count == 0)
+    {
+        j->ref_us = j->min_us = j->max_us = pulse_us;
+        j->sum = 0;
+        j->sum_sq = 0;
+    }
+    int64_t d = (int64_t)pulse_us - j->ref_us;
+    j->sum += d;
+    j->sum_sq += (uint64_t)(d * d);
+    if (pulse_us < j->min_us)
+        j->min_us = pulse_us;
+    if (pulse_us > j->max_us)
+        j->max_us = pulse_us;
+    if (++j->count == ACQ_JITTER_MAX_COUNT)
+    {
+        j->count /= 2;
+        j->sum /= 2;
+        j->sum_sq /= 2;
+    }
+}
+
+// Intertravamento avaliado nas IRQs
+static threshold_t thresh;
+
+static acq_irq_stats_t irq_stats[ACQ_IRQ_MODES];
+static volatile acq_irq_mode_t irq_mode_req;
+
+// Registro das bordas para o modo trace
+static edge_trace_t trace;
+static volatile bool tracing;
+
+static void HAL_ISR_FUNC(trace_event)(uint64_t t_us, unsigned int pin, trace_kind_t kind)
+{
+    if (tracing)
+        edge_trace_push(&trace, (uint32_t)t_us, (uint8_t)pin, kind);
+}
+
+#if HCSR04_USE_PIO
+static echo_pio_t echo_pio[SENSOR_COUNT];
+
+// A PIO gera o trigger e mede o echo; a IRQ só entrega o resultado pronto
+void HAL_ISR_FUNC(echo_pio_callback)(void)
+{
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        echo_pio_sample_t sample;
+        while (echo_pio_read(&echo_pio[i], &sample))
+        {
+            if (sample.status == ECHO_PIO_OK)
+            {
+                uint64_t t_descida = hal_time_us();
+                trace_event(t_descida - sample.width_us, sensor_pins[i].echo, TRACE_RISE);
+                trace_event(t_descida, sensor_pins[i].echo, TRACE_FALL);
+                if (sensor_on_pulse(&sensors[i], t_descida, sample.width_us))
+                    threshold_eval(&thresh, (uint8_t)i, distance_um(sample.width_us, sound_k),
+                                   sensors[i].t_trigger, t_descida);
+            }
+            else
+            {
+                uint64_t now = hal_time_us();
+                trace_event(now, sensor_pins[i].echo, TRACE_TIMEOUT);
+                if (sensor_on_timeout(&sensors[i]))
+                    threshold_eval(&thresh, (uint8_t)i, THRESHOLD_NO_ECHO, sensors[i].t_trigger, now);
+            }
+        }
+    }
+}
+#else
+// Sensor ligado a cada pino de echo, -1 se nenhum
+static int8_t echo_pin_sensor[HAL_GPIO_COUNT];
+
+int64_t HAL_ISR_FUNC(alarm_callback)(int32_t id, void *user_data)
+{
+    sensor_state_t *state = (sensor_state_t *)user_data;
+    uint8_t idx = (uint8_t)(state - sensors);
+    uint64_t now = hal_time_us();
+    trace_event(now, sensor_pins[idx].echo, TRACE_TIMEOUT);
+    if (sensor_on_timeout(state))
+        threshold_eval(&thresh, idx, THRESHOLD_NO_ECHO, state->t_trigger, now);
+    return 0;
+}
+
+static void HAL_ISR_FUNC(echo_edge)(unsigned int gpio, uint32_t events, uint64_t now)
+{
+    sensor_state_t *state = &sensors[echo_pin_sensor[gpio]];
+
+    // Subida e descida pendentes juntas só dão um instante para as duas: a
+    // largura se perdeu. O intertravamento não é avaliado, já que um pulso
+    // mais curto que a latência da IRQ seria um alvo muito perto, não a
+    // falta de echo.
+    if (events == (HAL_EDGE_RISE | HAL_EDGE_FALL))
+    {
+        trace_event(now, gpio, TRACE_TIMEOUT);
+        if (sensor_on_merged(state) && state->alarm_id > 0)
+            hal_alarm_cancel(state->alarm_id);
+        return;
+    }
+
+    if (events & HAL_EDGE_RISE)
+    {
+        trace_event(now, gpio, TRACE_RISE);
+        sensor_on_rise(state, now);
+    }
+
+    if (events & HAL_EDGE_FALL)
+    {
+        trace_event(now, gpio, TRACE_FALL);
+        if (sensor_on_fall(state, now))
+        {
+            // O pino do intertravamento é decidido antes de qualquer outra
+            // coisa
+            threshold_eval(&thresh, (uint8_t)echo_pin_sensor[gpio],
+                           distance_um((uint32_t)(now - state->t_subida), sound_k), state->t_trigger, now);
+            if (state->alarm_id > 0)
+                hal_alarm_cancel(state->alarm_id);
+        }
+    }
+}
+
+#if ACQ_RAW_IRQ
+// Pinos de echo, para o handler cru
+static uint32_t echo_mask;
+
+// Caminho em uso no core1
+static acq_irq_mode_t irq_mode;
+
+static uint32_t edge_count(uint32_t events)
+{
+    return ((events & HAL_EDGE_RISE) != 0) + ((events & HAL_EDGE_FALL) != 0);
+}
+
+// entry e stamp em hal_cycles(): entrada da IRQ e leitura do relógio
+static void HAL_ISR_FUNC(irq_stats_add)(acq_irq_mode_t mode, uint32_t entry, uint32_t stamp, uint32_t edges)
+{
+    acq_irq_stats_t *st = &irq_stats[mode];
+    uint32_t to_stamp = (stamp - entry) & HAL_CYCLES_MASK;
+    uint32_t cycles = (hal_cycles() - entry) & HAL_CYCLES_MASK;
+    if (st->irqs == 0)
+    {
+        st->stamp_min = st->stamp_max = to_stamp;
+        st->cycles_min = st->cycles_max = cycles;
+    }
+    if (to_stamp < st->stamp_min)
+        st->stamp_min = to_stamp;
+    if (to_stamp > st->stamp_max)
+        st->stamp_max = to_stamp;
+    if (cycles < st->cycles_min)
+        st->cycles_min = cycles;
+    if (cycles > st->cycles_max)
+        st->cycles_max = cycles;
+    st->stamp_sum += to_stamp;
+    st->cycles_sum += cycles;
+    st->edges += edges;
+    st->irqs++;
+}
+
+// Uma IRQ para todos os echos, sem o despachante do SDK: o relógio é lido
+// primeiro, e os eventos de todos os pinos são lidos e reconhecidos numa
+// varredura antes de tratar qualquer um
+void HAL_ISR_FUNC(echo_raw_irq)(void)
+{
+    uint32_t t32 = hal_time_us32();
+    uint32_t stamp = hal_cycles();
+
+    uint32_t pending[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        pending[i] = hal_gpio_irq_events(sensor_pins[i].echo) & (HAL_EDGE_RISE | HAL_EDGE_FALL);
+        if (pending[i])
+            hal_gpio_irq_ack(sensor_pins[i].echo, pending[i]);
+    }
+    // Nível lido depois dos eventos: uma borda que chegue no meio fica
+    // pendente para a próxima IRQ
+    uint32_t levels = hal_gpio_get_all();
+
+    // Estende os 32 bits lidos na entrada
+    uint64_t now = hal_time_us();
+    now -= (uint32_t)((uint32_t)now - t32);
+
+    uint32_t edges = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        uint32_t events = pending[i];
+        if (events == 0)
+            continue;
+
+        unsigned int pin = sensor_pins[i].echo;
+        edges += edge_count(events);
+        // Com as duas bordas pendentes o nível diz a ordem: em alto, um
+        // pulso acabou e outro começou; em baixo, subiu e desceu, e
+        // echo_edge descarta o pulso
+        if (events == (HAL_EDGE_RISE | HAL_EDGE_FALL) && (levels & (1u << pin)))
+        {
+            echo_edge(pin, HAL_EDGE_FALL, now);
+            events = HAL_EDGE_RISE;
+        }
+        echo_edge(pin, events, now);
+    }
+    irq_stats_add(ACQ_IRQ_RAW, hal_gpio_irq_entry(), stamp, edges);
+}
+#endif
+
+void HAL_ISR_FUNC(trigger_callback)(unsigned int gpio, uint32_t events)
+{
+#if ACQ_RAW_IRQ
+    uint32_t stamp = hal_cycles();
+#endif
+    uint64_t now = hal_time_us();
+
+    if (gpio >= HAL_GPIO_COUNT || echo_pin_sensor[gpio] < 0)
+        return;
+    echo_edge(gpio, events, now);
+#if ACQ_RAW_IRQ
+    irq_stats_add(ACQ_IRQ_SDK, hal_gpio_irq_entry(), stamp, edge_count(events));
+#endif
+}
+#endif
+
+// Envia o trigger e arma o timeout da medição em andamento
+// Sensores com o pino de echo em alto
+static uint32_t echo_high_mask(void)
+{
+    uint32_t levels = hal_gpio_get_all();
+    uint32_t mask = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (levels & (1u << sensor_pins[i].echo))
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+static void sensor_fire(int idx)
+{
+    // As IRQs de borda também gravam no anel
+    uint32_t irq = hal_irq_save();
+    trace_event(sensors[idx].t_trigger, sensor_pins[idx].trig, TRACE_TRIG);
+    hal_irq_restore(irq);
+
+#if HCSR04_USE_PIO
+    echo_pio_trigger(&echo_pio[idx], echo_timeout_us);
+#else
+    hal_gpio_put(sensor_pins[idx].trig, 1);
+    hal_sleep_us(10);
+    hal_gpio_put(sensor_pins[idx].trig, 0);
+    sensors[idx].alarm_id = hal_alarm_add_us(echo_timeout_us, alarm_callback, &sensors[idx]);
+#endif
+}
+
+// Soma um ping ao grupo do sensor. Retorna true e preenche m quando o grupo
+// fecha.
+static bool avg_add(int idx, const sensor_result_t *result, measurement_t *m)
+{
+    avg_acc_t *acc = &avg_acc[idx];
+    if (acc->done == 0)
+    {
+        memset(acc, 0, sizeof(*acc));
+        acc->shots = sched.shots;
+        acc->first_ping = result->ping;
+        acc->min_um = UINT32_MAX;
+    }
+
+    acc->done++;
+    if (result->ok)
+    {
+        uint32_t um = distance_um(result->pulse_us, sound_k);
+        acc->valid++;
+        acc->t_descida = result->t_descida;
+        acc->pulse_sum += result->pulse_us;
+        acc->um_sum += um;
+        if (um < acc->min_um)
+            acc->min_um = um;
+        if (um > acc->max_um)
+            acc->max_um = um;
+    }
+    if (acc->done < acc->shots)
+        return false;
+
+    bool ok = acc->valid > 0;
+    *m = (measurement_t){
+        .t_descida = ok ? acc->t_descida : result->t_trigger,
+        .seq = acc->first_ping,
+        .pulse_us = ok ? (uint32_t)(acc->pulse_sum / acc->valid) : 0,
+        .distance_um = ok ? (uint32_t)(acc->um_sum / acc->valid) : 0,
+        .min_um = ok ? acc->min_um : 0,
+        .max_um = acc->max_um,
+        .sensor = (uint8_t)idx,
+        .status = ok ? MEAS_OK : MEAS_TIMEOUT,
+        .shots = acc->shots,
+        .valid = acc->valid,
+    };
+    acc->done = 0;
+    return true;
+}
+
+bool acq_setup(void)
+{
+#if !HCSR04_USE_PIO
+    // Pool criado no core1, para que os timeouts rodem no mesmo core que as
+    // IRQs de borda
+    hal_alarm_init(SENSOR_COUNT + 1);
+    memset(echo_pin_sensor, -1, sizeof(echo_pin_sensor));
+#endif
+#if ACQ_RAW_IRQ
+    // Antes das IRQs de borda, para que a marca de entrada seja o primeiro
+    // handler da IRQ do banco; o callback do SDK é instalado abaixo e
+    // acq_poll passa ao handler cru se pedido
+    hal_cycles_init();
+    echo_mask = 0;
+    irq_mode = ACQ_IRQ_SDK;
+#endif
+
+    hal_gpio_output(THRESHOLD_OUT_PIN);
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        sensor_init(&sensors[i]);
+
+#if HCSR04_USE_PIO
+        if (!echo_pio_init(&echo_pio[i], sensor_pins[i].trig, sensor_pins[i].echo, echo_pio_callback))
+            return false;
+#else
+        hal_gpio_output(sensor_pins[i].trig);
+        hal_gpio_input(sensor_pins[i].echo);
+
+        echo_pin_sensor[sensor_pins[i].echo] = (int8_t)i;
+        hal_gpio_irq_enable(sensor_pins[i].echo, HAL_EDGE_FALL | HAL_EDGE_RISE, trigger_callback);
+#if ACQ_RAW_IRQ
+        echo_mask |= 1u << sensor_pins[i].echo;
+#endif
+#endif
+    }
+    return true;
+}
+
+bool acq_poll(void)
+{
+    uint64_t now = hal_time_us();
+    bool work = false;
+
+    if (reset_stats)
+    {
+        sched_reset_stats(&sched, now);
+        uint32_t irq = hal_irq_save();
+        threshold_reset_stats(&thresh);
+        for (int i = 0; i < SENSOR_COUNT; i++)
+        {
+            memset(sensors[i].rejected, 0, sizeof(sensors[i].rejected));
+            jitter[i].count = 0;
+        }
+        memset(irq_stats, 0, sizeof(irq_stats));
+        hal_irq_restore(irq);
+        reset_stats = false;
+    }
+
+    if (timing_changed)
+    {
+        timing_changed = false;
+        if (burst)
+            sched_set_timing(&sched, 0, burst_guard_us);
+        else
+            sched_set_timing(&sched, interval_us, SENSOR_GUARD_US);
+        sched_set_shots(&sched, avg_shots);
+        for (int i = 0; i < SENSOR_COUNT; i++)
+            avg_acc[i].done = 0;
+    }
+
+#if ACQ_RAW_IRQ
+    // Troca de caminho com as IRQs desligadas; bordas que chegarem no meio
+    // ficam pendentes e são atendidas pelo caminho novo
+    if (irq_mode_req != irq_mode)
+    {
+        uint32_t irq = hal_irq_save();
+        if (irq_mode_req == ACQ_IRQ_RAW)
+            hal_gpio_raw_irq_enable(echo_mask, HAL_EDGE_FALL | HAL_EDGE_RISE, echo_raw_irq);
+        else
+            hal_gpio_raw_irq_disable(echo_mask, echo_raw_irq);
+        irq_mode = irq_mode_req;
+        hal_irq_restore(irq);
+    }
+#endif
+
+    // Dispara uma nova medição sem esperar por ela: o avanço
+    // IDLE -> TRIGGERED -> ECHO_HIGH -> DONE/TIMEOUT acontece nas IRQs
+    if (running)
+    {
+        sched_set_busy(&sched, echo_high_mask());
+        int idx = sched_next(&sched, now);
+#if HCSR04_USE_PIO
+        // O orçamento da PIO já limita o pulso; o instante da descida é o
+        // da IRQ, atrasado pela latência, e não serve para a janela
+        uint32_t window_us = 0;
+#else
+        // Bordas só valem até o timeout deste disparo
+        uint32_t window_us = echo_timeout_us;
+#endif
+        if (idx >= 0 && sensor_trigger(&sensors[idx], now, ping_seq, window_us))
+        {
+            ping_seq++;
+            sensor_fire(idx);
+            work = true;
+        }
+    }
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        sensor_result_t result;
+        if (!sensor_take_result(&sensors[i], &result))
+            continue;
+
+#if !HCSR04_USE_PIO
+        if (sensors[i].alarm_id > 0)
+        {
+            hal_alarm_cancel(sensors[i].alarm_id);
+        }
+#endif
+        sched_done(&sched, i, result.ok, hal_time_us());
+        if (result.ok)
+            jitter_add(&jitter[i], result.pulse_us);
+        work = true;
+
+        // Com oversampling só o último ping do grupo gera registro
+        measurement_t m;
+        if (!avg_add(i, &result, &m))
+            continue;
+        meas_ring_push(&ring, &m);
+        hal_event_signal(); // acorda o core0
+    }
+    return work;
+}
+
+void acq_init(void)
+{
+    sched_init(&sched, SENSOR_COUNT, MEASUREMENT_INTERVAL_MS * 1000, SENSOR_GUARD_US);
+    meas_ring_init(&ring);
+    running = false;
+    reset_stats = false;
+    interval_us = MEASUREMENT_INTERVAL_MS * 1000;
+    burst = false;
+    burst_guard_us = BURST_GUARD_US;
+    timing_changed = false;
+    sound_k = DISTANCE_K_Q8_DEFAULT;
+    avg_shots = 1;
+    memset(avg_acc, 0, sizeof(avg_acc));
+    memset(jitter, 0, sizeof(jitter));
+    memset(irq_stats, 0, sizeof(irq_stats));
+    irq_mode_req = ACQ_RAW_IRQ ? ACQ_IRQ_RAW : ACQ_IRQ_SDK;
+    ping_seq = 0;
+    tracing = false;
+    edge_trace_init(&trace);
+    threshold_init(&thresh);
+    acq_set_max_range(SENSOR_MAX_RANGE_MM);
+}
+
+void acq_set_running(bool run)
+{
+    if (run)
+        acq_reset_stats();
+    running = run;
+}
+
+void acq_reset_stats(void)
+{
+    reset_stats = true;
+}
+
+bool acq_set_max_range(uint32_t range_mm)
+{
+    if (range_mm < SENSOR_RANGE_MIN_MM || range_mm > SENSOR_RANGE_LIMIT_MM)
+        return false;
+
+    // Vale a partir do próximo trigger
+    max_range_mm = range_mm;
+    echo_timeout_us = sensor_echo_timeout_us(range_mm);
+    return true;
+}
+
+bool acq_set_echo_timeout(uint32_t timeout_us)
+{
+    if (timeout_us < ACQ_TIMEOUT_MIN_US || timeout_us > ACQ_TIMEOUT_MAX_US)
+        return false;
+
+    echo_timeout_us = timeout_us;
+    return true;
+}
+
+uint32_t acq_max_range(void)
+{
+    return max_range_mm;
+}
+
+uint32_t acq_echo_timeout_us(void)
+{
+    return echo_timeout_us;
+}
+
+bool acq_set_interval(uint32_t us)
+{
+    if (us == 0)
+        return false;
+
+    interval_us = us;
+    timing_changed = true;
+    return true;
+}
+
+uint32_t acq_interval_us(void)
+{
+    return interval_us;
+}
+
+bool acq_set_burst(bool on, uint32_t guard_us)
+{
+    if (guard_us < ACQ_BURST_GUARD_MIN_US || guard_us > ACQ_BURST_GUARD_MAX_US)
+        return false;
+
+    burst_guard_us = guard_us;
+    burst = on;
+    timing_changed = true;
+    return true;
+}
+
+bool acq_burst(void)
+{
+    return burst;
+}
+
+uint32_t acq_burst_guard_us(void)
+{
+    return burst_guard_us;
+}
+
+bool acq_set_average(uint32_t shots)
+{
+    if (shots < 1 || shots > AVG_MAX_SHOTS)
+        return false;
+
+    avg_shots = (uint8_t)shots;
+    timing_changed = true;
+    return true;
+}
+
+uint32_t acq_average(void)
+{
+    return avg_shots;
+}
+
+void acq_set_sound_k(uint32_t k_q8)
+{
+    sound_k = k_q8;
+}
+
+uint32_t acq_sound_k(void)
+{
+    return sound_k;
+}
+
+const scheduler_t *acq_scheduler(void)
+{
+    return &sched;
+}
+
+void acq_set_trace(bool on)
+{
+    if (on && !tracing)
+        edge_trace_init(&trace);
+    tracing = on;
+}
+
+bool acq_trace_enabled(void)
+{
+    return tracing;
+}
+
+edge_trace_t *acq_trace(void)
+{
+    return &trace;
+}
+
+const acq_jitter_t *acq_jitter(int idx)
+{
+    return &jitter[idx];
+}
+
+bool acq_set_irq_mode(acq_irq_mode_t mode)
+{
+    if (mode != ACQ_IRQ_SDK && !(ACQ_RAW_IRQ && mode == ACQ_IRQ_RAW))
+        return false;
+
+    irq_mode_req = mode;
+    return true;
+}
+
+acq_irq_mode_t acq_irq_mode(void)
+{
+    return irq_mode_req;
+}
+
+const acq_irq_stats_t *acq_irq_stats(acq_irq_mode_t mode)
+{
+    return &irq_stats[mode];
+}
+
+const sensor_state_t *acq_sensor(int idx)
+{
+    return &sensors[idx];
+}
+
+threshold_t *acq_threshold(void)
+{
+    return &thresh;
+}
+
+meas_ring_t *acq_ring(void)
+{
+    return &ring;
+}
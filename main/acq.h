@@ -0,0 +1,146 @@
+#ifndef ACQ_H
+#define ACQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "edge_trace.h"
+#include "meas_ring.h"
+#include "scheduler.h"
+#include "sensor.h"
+#include "threshold.h"
+
+// Aquisição no core1: trigger, IRQs de borda e alarmes de timeout rodam
+// todos no core1, e cada medição concluída vira um measurement_t no anel
+// lido pelo core0. O hardware é acessado pela hal.h.
+
+// Estado inicial; chamado antes de iniciar o contexto da aquisição
+void acq_init(void);
+
+// Configura os sensores no contexto da aquisição (core1), que passa a
+// receber as IRQs. Retorna false se falhou (ex.: sem state machine PIO
+// livre).
+bool acq_setup(void);
+
+// Uma volta do loop da aquisição: dispara o próximo sensor devido e
+// entrega os resultados prontos. Retorna true se houve trabalho.
+bool acq_poll(void);
+
+void acq_set_running(bool running);
+
+// Pede ao core1 que zere os contadores do escalonador
+void acq_reset_stats(void);
+
+// Alcance máximo em mm; o timeout do echo é derivado dele. Retorna false
+// fora de SENSOR_RANGE_MIN_MM..SENSOR_RANGE_LIMIT_MM.
+bool acq_set_max_range(uint32_t range_mm);
+uint32_t acq_max_range(void);
+uint32_t acq_echo_timeout_us(void);
+
+// Define o timeout do echo diretamente, sem passar pelo alcance
+#define ACQ_TIMEOUT_MIN_US 1000
+#define ACQ_TIMEOUT_MAX_US 100000
+bool acq_set_echo_timeout(uint32_t timeout_us);
+
+// Intervalo entre medições do mesmo sensor no modo periódico
+bool acq_set_interval(uint32_t interval_us);
+uint32_t acq_interval_us(void);
+
+// Modo burst: cada sensor é redisparado assim que o echo anterior termina
+// e passa guard_us (ringdown), em vez de a cada MEASUREMENT_INTERVAL_MS.
+// Retorna false, sem mudar nada, com guard_us fora dos limites: abaixo do
+// mínimo o transdutor ainda vibra do ping anterior, e acima do máximo a
+// medição praticamente para.
+#define ACQ_BURST_GUARD_MIN_US 1000
+#define ACQ_BURST_GUARD_MAX_US 1000000
+bool acq_set_burst(bool on, uint32_t guard_us);
+bool acq_burst(void);
+uint32_t acq_burst_guard_us(void);
+
+// Oversampling: cada leitura devida vira shots pings seguidos do mesmo
+// sensor (separados pela guarda de ringdown), entregues como um único
+// registro com média, mínimo, máximo e pings válidos. 1 = desligado.
+// Retorna false fora de 1..AVG_MAX_SHOTS.
+bool acq_set_average(uint32_t shots);
+uint32_t acq_average(void);
+
+// Fator de conversão pulso -> distância (Q8, ver distance.h) aplicado às
+// próximas medições
+void acq_set_sound_k(uint32_t k_q8);
+uint32_t acq_sound_k(void);
+
+// Contadores do escalonador (escritos pelo core1; leitura só para relatório)
+const scheduler_t *acq_scheduler(void);
+
+// Modo trace: grava trigger, bordas e timeouts no anel de eventos, lido
+// pelo core0. Ligar zera o anel.
+void acq_set_trace(bool on);
+bool acq_trace_enabled(void);
+edge_trace_t *acq_trace(void);
+
+// Dispersão da largura do pulso de cada sensor desde o último reset dos
+// contadores. Com alvo parado mede o jitter dos timestamps das bordas, já
+// que as duas passam pela latência da IRQ. Somas dos desvios em relação à
+// primeira amostra; ao chegar a ACQ_JITTER_MAX_COUNT amostras as somas e a
+// contagem caem pela metade (a média e a variância se mantêm), então com
+// pulsos até ACQ_TIMEOUT_MAX_US sum_sq fica abaixo de 2^24 * 1e10.
+#define ACQ_JITTER_MAX_COUNT (1u << 24)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t ref_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    int64_t sum;
+    uint64_t sum_sq;
+} acq_jitter_t;
+
+const acq_jitter_t *acq_jitter(int idx);
+
+// Caminho das IRQs de borda do echo (sem PIO). ACQ_IRQ_RAW, com
+// HCSR04_RAW_GPIO_IRQ, é um handler próprio na IRQ do banco de GPIO: lê o
+// timer antes de qualquer despacho e atende todos os echos pendentes de
+// uma vez. ACQ_IRQ_SDK é o callback comum do SDK, mantido para comparação.
+// A troca é feita pelo core1 na próxima volta de acq_poll. Retorna false
+// se o build não tem o caminho.
+typedef enum
+{
+    ACQ_IRQ_SDK,
+    ACQ_IRQ_RAW,
+    ACQ_IRQ_MODES
+} acq_irq_mode_t;
+
+bool acq_set_irq_mode(acq_irq_mode_t mode);
+acq_irq_mode_t acq_irq_mode(void);
+
+// Custo de cada caminho em ciclos da CPU, contados da entrada da IRQ (antes
+// de qualquer handler) até a leitura do relógio e até o fim do tratamento.
+// No callback do SDK cada pino é uma chamada; no handler cru uma IRQ pode
+// trazer bordas de vários echos. Só com HCSR04_RAW_GPIO_IRQ.
+typedef struct
+{
+    uint32_t irqs;
+    uint32_t edges;
+    uint32_t stamp_min;
+    uint32_t stamp_max;
+    uint64_t stamp_sum;
+    uint32_t cycles_min;
+    uint32_t cycles_max;
+    uint64_t cycles_sum;
+} acq_irq_stats_t;
+
+const acq_irq_stats_t *acq_irq_stats(acq_irq_mode_t mode);
+
+// Estado de um sensor, para os contadores de bordas rejeitadas (escritos
+// nas IRQs; leitura só para relatório)
+const sensor_state_t *acq_sensor(int idx);
+
+// Intertravamento por limiares, avaliado nas IRQs do core1. Limiares e
+// anel de eventos para o core0; contadores só para relatório.
+threshold_t *acq_threshold(void);
+
+// Anel de medições: o core1 produz, o core0 consome
+meas_ring_t *acq_ring(void);
+
+#endif
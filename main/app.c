@@ -0,0 +1,279 @@
+#include "app.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "acq.h"
+#include "commands.h"
+#include "config.h"
+#include "distance.h"
+#include "frame.h"
+#include "hal.h"
+#include "sound.h"
+#include "temp_sensor.h"
+
+app_t app;
+
+static uint64_t last_temp_update;
+static uint64_t last_trace_flush;
+
+// Taxa alcançada no modo burst, relatada a cada BURST_REPORT_MS
+static uint32_t burst_count;
+static uint64_t burst_window_start;
+
+static void chars_available_callback(void *param)
+{
+    int ch;
+    while ((ch = hal_stdio_getchar()) >= 0)
+    {
+        line_rx_push(&app.rx, (uint8_t)ch, (uint32_t)hal_time_us());
+    }
+    hal_event_signal();
+}
+
+void app_update_temperature(int32_t deci)
+{
+    app.temp_deci = deci;
+    acq_set_sound_k(sound_k_q8(deci));
+}
+
+void out_printf(const char *fmt, ...)
+{
+    char line[OUT_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (len < 0)
+        return;
+    if (len > OUT_LINE_TEXT_MAX)
+        len = OUT_LINE_TEXT_MAX;
+    len += snprintf(&line[len], sizeof(line) - (size_t)len, "%s", hal_stdio_eol);
+    out_ring_write(&app.out, line, (size_t)len, (uint32_t)hal_time_us());
+}
+
+static void out_write(const uint8_t *data, size_t len, void *ctx)
+{
+    hal_stdio_write(data, len);
+}
+
+// Instante da captura: hora UTC se 'settime' foi usado, senão desde o boot
+static void format_stamp(char *stamp, size_t size, uint64_t t_us)
+{
+    if (app.epoch_set)
+    {
+        uint64_t t = t_us + (uint64_t)app.epoch_offset_us;
+        uint32_t day_s = (uint32_t)(t / 1000000 % 86400);
+        snprintf(stamp, size, "%02lu:%02lu:%02lu.%06lu", (unsigned long)(day_s / 3600),
+                 (unsigned long)(day_s / 60 % 60), (unsigned long)(day_s % 60), (unsigned long)(t % 1000000));
+    }
+    else
+    {
+        snprintf(stamp, size, "%lu.%06lu", (unsigned long)(t_us / 1000000), (unsigned long)(t_us % 1000000));
+    }
+}
+
+static void print_threshold(const threshold_event_t *e)
+{
+    if (app.format == OUT_BIN)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        uint8_t frame[FRAME_MAX_ENCODED];
+        size_t len = frame_encode(payload, frame_pack_threshold(e, payload), frame);
+        out_ring_write(&app.out, frame, len, (uint32_t)hal_time_us());
+        return;
+    }
+
+    char stamp[24];
+    format_stamp(stamp, sizeof(stamp), e->t_us);
+    char cm[DISTANCE_CM_STR_MAX + 3] = "sem eco";
+    if (e->distance_um != THRESHOLD_NO_ECHO)
+    {
+        distance_format_cm(cm, e->distance_um);
+        strcat(cm, " cm");
+    }
+    out_printf("%s - sensor %d: %s, %s (%u us)", stamp, e->sensor, e->near ? "PERTO" : "LONGE", cm,
+               (unsigned)e->latency_us);
+}
+
+static void print_measurement(const measurement_t *m)
+{
+    if (app.format == OUT_BIN)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        uint8_t frame[FRAME_MAX_ENCODED];
+        size_t n;
+        if (m->shots > 1)
+            n = frame_pack_average(m, payload);
+        else if (kalman_enabled(&app.kalman[m->sensor]))
+            n = frame_pack_track(m, payload);
+        else
+            n = frame_pack_measurement(m, payload);
+        size_t len = frame_encode(payload, n, frame);
+        out_ring_write(&app.out, frame, len, (uint32_t)hal_time_us());
+        return;
+    }
+
+    char stamp[24];
+    format_stamp(stamp, sizeof(stamp), m->t_descida);
+
+    char sensor[16] = "";
+    if (SENSOR_COUNT > 1)
+    {
+        snprintf(sensor, sizeof(sensor), "sensor %d: ", m->sensor);
+    }
+    if (m->status == MEAS_OK)
+    {
+        char cm[DISTANCE_CM_STR_MAX];
+        distance_format_cm(cm, m->distance_um);
+
+        // Velocidade em cm/s com duas casas, positiva afastando
+        char vel[24] = "";
+        if (kalman_enabled(&app.kalman[m->sensor]))
+        {
+            int32_t v = m->velocity_um_s / 100;
+            uint32_t av = (uint32_t)(v < 0 ? -v : v);
+            snprintf(vel, sizeof(vel), ", %s%lu.%02lu cm/s", v < 0 ? "-" : "+", (unsigned long)(av / 100),
+                     (unsigned long)(av % 100));
+        }
+
+        // Oversampling: pings válidos e extremos do grupo
+        char avg[24 + 2 * DISTANCE_CM_STR_MAX] = "";
+        if (m->shots > 1)
+        {
+            char lo[DISTANCE_CM_STR_MAX];
+            char hi[DISTANCE_CM_STR_MAX];
+            distance_format_cm(lo, m->min_um);
+            distance_format_cm(hi, m->max_um);
+            snprintf(avg, sizeof(avg), " (%u/%u, %s a %s cm)", (unsigned)m->valid, (unsigned)m->shots, lo, hi);
+        }
+        out_printf("%s - %s%s cm%s%s", stamp, sensor, cm, vel, avg);
+    }
+    else if (m->status == MEAS_OUTLIER)
+    {
+        char cm[DISTANCE_CM_STR_MAX];
+        distance_format_cm(cm, m->distance_um);
+        out_printf("%s - %sDescartada (mediana %s cm)", stamp, sensor, cm);
+    }
+    else if (m->shots > 1)
+    {
+        out_printf("%s - %sFalha (0/%u)", stamp, sensor, (unsigned)m->shots);
+    }
+    else
+    {
+        out_printf("%s - %sFalha", stamp, sensor);
+    }
+}
+
+void app_init(void)
+{
+    memset(&app, 0, sizeof(app));
+    temp_sensor_init();
+    app_update_temperature(temp_sensor_read_deci());
+    last_temp_update = hal_time_us();
+    last_trace_flush = last_temp_update;
+
+    commands_init();
+    out_ring_init(&app.out, OUT_DROP_NEWEST);
+    line_rx_init(&app.rx);
+    line_asm_init(&app.line);
+    hal_stdio_set_rx_callback(chars_available_callback, NULL);
+
+    burst_count = 0;
+    burst_window_start = hal_time_us();
+
+    out_printf("Digite 'start' para iniciar a leitura e 'stop' para parar:");
+    commands_print_help();
+    commands_print_range();
+    commands_print_temperature();
+}
+
+bool app_poll(void)
+{
+    bool work = false;
+
+    // Comandos montados a partir dos bytes recebidos na IRQ do stdio
+    uint8_t c;
+    uint32_t t_rx;
+    while (line_rx_pop(&app.rx, &c, &t_rx))
+    {
+        if (line_asm_feed(&app.line, c, t_rx))
+        {
+            commands_execute(app.line.buf);
+            line_latency_add(&app.cmd_latency, (uint32_t)hal_time_us() - app.line.t_end_us);
+        }
+        work = true;
+    }
+
+    // Transições do intertravamento, já aplicadas ao pino pela IRQ
+    threshold_event_t ev;
+    while (threshold_pop(acq_threshold(), &ev))
+    {
+        print_threshold(&ev);
+        work = true;
+    }
+
+    // Medições entregues pelo core1
+    measurement_t m;
+    while (meas_ring_pop(acq_ring(), &m))
+    {
+        median_filter_apply(&app.filter[m.sensor], &m);
+        kalman_apply(&app.kalman[m.sensor], &m);
+        if (deadband_pass(&app.deadband[m.sensor], &m))
+            print_measurement(&m);
+        work = true;
+        if (m.status == MEAS_OK)
+        {
+            burst_count++;
+        }
+
+        if (app.count_left > 0 && --app.count_left == 0)
+        {
+            acq_set_running(false);
+            out_printf("Leitura parada!");
+        }
+    }
+
+    uint64_t now = hal_time_us();
+    if (!app.temp_manual && now - last_temp_update >= TEMP_UPDATE_MS * 1000ull)
+    {
+        app_update_temperature(temp_sensor_read_deci());
+        last_temp_update = now;
+    }
+
+    if (now - burst_window_start >= BURST_REPORT_MS * 1000ull)
+    {
+        if (acq_burst() && burst_count > 0)
+        {
+            uint32_t rate = (uint32_t)(burst_count * 1000000000ull / (now - burst_window_start));
+            out_printf("burst: %lu.%03lu leituras/s", (unsigned long)(rate / 1000),
+                       (unsigned long)(rate % 1000));
+        }
+        burst_count = 0;
+        burst_window_start = now;
+    }
+
+    // Eventos do modo trace, em quadros binários cheios ou a cada
+    // TRACE_FLUSH_MS
+    edge_trace_t *trace = acq_trace();
+    if (edge_trace_count(trace) >= TRACE_BATCH_EVENTS ||
+        (edge_trace_count(trace) > 0 && now - last_trace_flush >= TRACE_FLUSH_MS * 1000ull))
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        size_t n;
+        while ((n = edge_trace_pack(trace, payload, sizeof(payload))) > 0)
+        {
+            uint8_t frame[FRAME_MAX_ENCODED];
+            out_ring_write(&app.out, frame, frame_encode(payload, n, frame), (uint32_t)now);
+        }
+        last_trace_flush = now;
+        work = true;
+    }
+
+    // Esvazia a fila de saída só até onde o stdio aceita sem bloquear; o
+    // resto espera o próximo passo (o tick acorda o loop)
+    if (out_ring_drain(&app.out, hal_stdio_writable(), out_write, NULL, (uint32_t)hal_time_us()) > 0)
+        work = true;
+    return work;
+}
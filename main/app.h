@@ -0,0 +1,67 @@
+#ifndef APP_H
+#define APP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "deadband.h"
+#include "kalman.h"
+#include "line_input.h"
+#include "median_filter.h"
+#include "out_ring.h"
+
+// Formato das medições na saída
+typedef enum
+{
+    OUT_TEXT = 0,
+    OUT_BIN, // quadros COBS + CRC, ver frame.h
+} out_format_t;
+
+// Estado do core0 compartilhado entre o loop principal e os comandos
+typedef struct
+{
+    line_rx_t rx;
+    line_asm_t line;
+    line_latency_t cmd_latency;
+
+    int32_t temp_deci; // temperatura usada na compensação do som
+    bool temp_manual;
+
+    out_ring_t out; // toda a saída, esvaziada pelo loop principal
+    int64_t epoch_offset_us; // hora UTC = time_us_64() + offset, após 'settime'
+    bool epoch_set;
+
+    median_filter_t filter[SENSOR_COUNT]; // por sensor, desligado por padrão
+    kalman_t kalman[SENSOR_COUNT];        // depois da mediana, desligado por padrão
+    deadband_t deadband[SENSOR_COUNT];    // entre os filtros e a saída
+
+    out_format_t format;
+    uint32_t count_left; // medições até parar, 0 = sem limite
+} app_t;
+
+extern app_t app;
+
+// Maior linha de out_printf(), com o fim de linha e o '\0'; o texto além de
+// OUT_LINE_TEXT_MAX bytes é truncado
+#define OUT_LINE_MAX 192
+#define OUT_LINE_TEXT_MAX (OUT_LINE_MAX - 3)
+
+// Enfileira uma linha de texto na fila de saída, com o fim de linha do
+// stdio (a fila é enviada sem tradução). Toda saída de texto do core0
+// (medições e respostas dos comandos) passa por aqui: nada bloqueia no
+// stdio, e o que não couber entra nos descartes da fila.
+void out_printf(const char *fmt, ...);
+
+// Inicia o core0 depois de acq_setup: entrada de comandos, saída e
+// temperatura
+void app_init(void);
+
+// Uma volta do loop principal: comandos recebidos, medições prontas,
+// tarefas por tempo e envio da fila de saída. Retorna true se houve
+// trabalho.
+bool app_poll(void);
+
+void app_update_temperature(int32_t deci);
+
+#endif
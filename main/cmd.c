@@ -0,0 +1,172 @@
+#include "cmd.h"
+
+#include <string.h>
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Quebra a linha em palavras. Retorna a quantidade, ou -1 se passou de max.
+static int tokenize(char *line, char **words, int max)
+{
+    int n = 0;
+    char *p = line;
+    while (true)
+    {
+        while (is_space(*p))
+            p++;
+        if (*p == '\0')
+            return n;
+        if (n == max)
+            return -1;
+
+        words[n++] = p;
+        while (*p != '\0' && !is_space(*p))
+            p++;
+        if (*p != '\0')
+            *p++ = '\0';
+    }
+}
+
+static const cmd_def_t *lookup(const cmd_def_t *table, size_t count, const char *name)
+{
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = strcmp(name, table[mid].name);
+        if (c == 0)
+            return &table[mid];
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+bool cmd_parse_uint(const char *str, uint32_t *out)
+{
+    if (!is_digit(*str))
+        return false;
+
+    uint32_t v = 0;
+    for (; *str != '\0'; str++)
+    {
+        if (!is_digit(*str))
+            return false;
+        uint32_t d = (uint32_t)(*str - '0');
+        if (v > (UINT32_MAX - d) / 10u)
+            return false;
+        v = v * 10u + d;
+    }
+    *out = v;
+    return true;
+}
+
+bool cmd_parse_int(const char *str, int32_t *out)
+{
+    bool neg = (*str == '-');
+    uint32_t mag;
+    if (!cmd_parse_uint(neg ? str + 1 : str, &mag))
+        return false;
+    if (mag > (neg ? 0x80000000u : 0x7FFFFFFFu))
+        return false;
+
+    *out = neg ? (int32_t)(0u - mag) : (int32_t)mag;
+    return true;
+}
+
+bool cmd_parse_deci(const char *str, int32_t *out)
+{
+    bool neg = (*str == '-');
+    const char *p = neg ? str + 1 : str;
+
+    uint32_t whole = 0;
+    if (!is_digit(*p))
+        return false;
+    for (; is_digit(*p); p++)
+    {
+        whole = whole * 10u + (uint32_t)(*p - '0');
+        if (whole > 100000000u)
+            return false;
+    }
+
+    uint32_t tenths = 0;
+    if (*p == '.')
+    {
+        if (!is_digit(p[1]) || p[2] != '\0')
+            return false;
+        tenths = (uint32_t)(p[1] - '0');
+        p += 2;
+    }
+    if (*p != '\0')
+        return false;
+
+    int32_t v = (int32_t)(whole * 10u + tenths);
+    *out = neg ? -v : v;
+    return true;
+}
+
+static bool parse_arg(char type, const char *word, cmd_arg_t *arg)
+{
+    switch (type)
+    {
+    case 'u':
+        return cmd_parse_uint(word, &arg->u);
+    case 'i':
+        return cmd_parse_int(word, &arg->i);
+    case 'd':
+        return cmd_parse_deci(word, &arg->i);
+    case 'w':
+        arg->w = word;
+        return true;
+    }
+    return false;
+}
+
+cmd_status_t cmd_execute(const cmd_def_t *table, size_t count, char *line, const cmd_def_t **matched)
+{
+    char *words[CMD_MAX_ARGS + 1];
+    *matched = NULL;
+
+    int n = tokenize(line, words, CMD_MAX_ARGS + 1);
+    if (n == 0)
+        return CMD_EMPTY;
+
+    const cmd_def_t *cmd = lookup(table, count, words[0]);
+    if (cmd == NULL)
+        return CMD_UNKNOWN;
+    *matched = cmd;
+
+    // n == -1: mais palavras que CMD_MAX_ARGS argumentos
+    int argc = n - 1;
+    if (n < 0 || argc < cmd->min_args || argc > (int)strlen(cmd->args))
+        return CMD_BAD_ARGS;
+
+    cmd_arg_t argv[CMD_MAX_ARGS];
+    for (int i = 0; i < argc; i++)
+    {
+        if (!parse_arg(cmd->args[i], words[i + 1], &argv[i]))
+            return CMD_BAD_ARGS;
+    }
+
+    return cmd->handler(argc, argv) ? CMD_OK : CMD_REJECTED;
+}
+
+bool cmd_table_sorted(const cmd_def_t *table, size_t count)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        if (strcmp(table[i - 1].name, table[i].name) >= 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef CMD_H
+#define CMD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Interpretador de comandos por tabela. A linha é quebrada em palavras no
+// próprio buffer, o nome é procurado por busca binária numa tabela estática
+// ordenada e os argumentos são convertidos conforme a especificação do
+// comando antes de chamar o handler. Nada é alocado.
+
+// Máximo de argumentos após o nome
+#define CMD_MAX_ARGS 4
+
+// Tipos de argumento, um caractere por argumento em cmd_def_t.args:
+//   'u'  inteiro sem sinal (uint32_t)
+//   'i'  inteiro com sinal (int32_t)
+//   'd'  decimal com uma casa, em décimos ("-3.5" -> -35)
+//   'w'  palavra, repassada como texto
+typedef union
+{
+    uint32_t u;
+    int32_t i;
+    const char *w;
+} cmd_arg_t;
+
+// Retorna false se os valores são válidos quanto ao tipo mas não ao comando
+typedef bool (*cmd_handler_t)(int argc, const cmd_arg_t *argv);
+
+typedef struct
+{
+    const char *name;
+    cmd_handler_t handler;
+    const char *args;  // especificação dos argumentos, "" se nenhum
+    uint8_t min_args;  // argumentos obrigatórios (os demais são opcionais)
+    const char *usage; // texto de ajuda dos argumentos
+} cmd_def_t;
+
+typedef enum
+{
+    CMD_OK = 0,
+    CMD_EMPTY,     // linha só com espaços
+    CMD_UNKNOWN,   // nome não está na tabela
+    CMD_BAD_ARGS,  // quantidade ou tipo de argumento errado
+    CMD_REJECTED,  // o handler recusou os valores
+} cmd_status_t;
+
+// Interpreta e executa uma linha. A linha é modificada. Em *matched fica o
+// comando encontrado (ou NULL), para mensagens de uso.
+cmd_status_t cmd_execute(const cmd_def_t *table, size_t count, char *line, const cmd_def_t **matched);
+
+// Confere se a tabela está em ordem estritamente crescente de nome
+bool cmd_table_sorted(const cmd_def_t *table, size_t count);
+
+bool cmd_parse_uint(const char *str, uint32_t *out);
+bool cmd_parse_int(const char *str, int32_t *out);
+bool cmd_parse_deci(const char *str, int32_t *out);
+
+#endif
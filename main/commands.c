@@ -0,0 +1,728 @@
+#include "commands.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "acq.h"
+#include "app.h"
+#include "cmd.h"
+#include "config.h"
+#include "distance.h"
+#include "frame.h"
+#include "hal.h"
+#include "sound.h"
+#include "temp_sensor.h"
+
+// Limites do comando 'rate', em leituras por segundo de cada sensor
+#define RATE_MIN_HZ 1
+#define RATE_MAX_HZ 100
+
+void commands_print_range(void)
+{
+    out_printf("Alcance máximo: %lu mm (timeout %lu us)",
+               (unsigned long)acq_max_range(), (unsigned long)acq_echo_timeout_us());
+}
+
+void commands_print_temperature(void)
+{
+    int32_t t = app.temp_deci < 0 ? -app.temp_deci : app.temp_deci;
+    out_printf("Temperatura: %s%ld.%ld C (%s), som a %lu mm/s", app.temp_deci < 0 ? "-" : "",
+               (long)(t / 10), (long)(t % 10), app.temp_manual ? "manual" : "sensor interno",
+               (unsigned long)sound_speed_mm_s(acq_sound_k()));
+}
+
+static void print_mode(void)
+{
+    if (acq_burst())
+    {
+        out_printf("Modo burst, guarda de %lu us", (unsigned long)acq_burst_guard_us());
+    }
+    else
+    {
+        uint32_t mhz = (uint32_t)(1000000000ull / acq_interval_us());
+        out_printf("Modo periódico, %lu.%03lu leituras/s por sensor", (unsigned long)(mhz / 1000),
+                   (unsigned long)(mhz % 1000));
+    }
+}
+
+static void print_average(void)
+{
+    if (acq_average() <= 1)
+        out_printf("Oversampling: off");
+    else
+        out_printf("Oversampling: média de %lu pings por leitura", (unsigned long)acq_average());
+}
+
+static uint32_t isqrt64(uint64_t x)
+{
+    uint64_t r = 0;
+    for (uint64_t bit = 1ull << 62; bit != 0; bit >>= 2)
+    {
+        if (x >= r + bit)
+        {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+    }
+    return (uint32_t)r;
+}
+
+// Largura do pulso: média, desvio padrão (em centésimos de us) e faixa
+static void print_jitter(int i)
+{
+    const acq_jitter_t *j = acq_jitter(i);
+    if (j->count < 2)
+        return;
+
+    // Soma dos quadrados em torno da média inteira m (sum = n m + r, |r| < n),
+    // sem o quadrado de sum: sum_sq - m (2 sum - n m) - r^2 / n
+    int64_t n = j->count;
+    int64_t m = j->sum / n;
+    int64_t r = j->sum - n * m;
+    // (a metade truncada de jitter_add pode deixar um resto negativo)
+    int64_t sq = (int64_t)j->sum_sq - m * (2 * j->sum - n * m) - r * r / n;
+    if (sq < 0)
+        sq = 0;
+    // Variância em (centésimos de us)^2, com a divisão antes do fator para
+    // não estourar
+    uint64_t var = (uint64_t)(sq / n * 10000 + sq % n * 10000 / n);
+    uint32_t sd = isqrt64(var);
+    out_printf("pulso %d: média %ld us, desvio %lu.%02lu us, faixa %lu a %lu us", i,
+               (long)(j->ref_us + j->sum / n), (unsigned long)(sd / 100), (unsigned long)(sd % 100),
+               (unsigned long)j->min_us, (unsigned long)j->max_us);
+}
+
+static const char *const irq_mode_names[ACQ_IRQ_MODES] = {"sdk", "raw"};
+
+static void print_irq_mode(void)
+{
+    out_printf("IRQ de borda: %s", acq_irq_mode() == ACQ_IRQ_RAW ? "raw (handler próprio)" : "sdk (callback)");
+}
+
+// Ciclos de cada caminho de IRQ desde o último reset, para comparação
+static void print_irq_stats(void)
+{
+    for (int m = 0; m < ACQ_IRQ_MODES; m++)
+    {
+        const acq_irq_stats_t *st = acq_irq_stats((acq_irq_mode_t)m);
+        if (st->irqs == 0)
+            continue;
+        out_printf("irq %s: %lu chamadas, %lu bordas, entrada->relógio %lu/%lu/%lu ciclos, "
+                   "total %lu/%lu/%lu ciclos (mín/média/máx)",
+                   irq_mode_names[m], (unsigned long)st->irqs, (unsigned long)st->edges,
+                   (unsigned long)st->stamp_min, (unsigned long)(st->stamp_sum / st->irqs),
+                   (unsigned long)st->stamp_max, (unsigned long)st->cycles_min,
+                   (unsigned long)(st->cycles_sum / st->irqs), (unsigned long)st->cycles_max);
+    }
+}
+
+static void print_stats(void)
+{
+    const scheduler_t *sched = acq_scheduler();
+    uint64_t now = hal_time_us();
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        uint32_t rate = sched_rate_mhz(sched, i, now);
+        out_printf("sensor %d: %lu ok, %lu falhas, %lu.%03lu leituras/s", i,
+                   (unsigned long)sched->ok[i], (unsigned long)sched->failed[i],
+                   (unsigned long)(rate / 1000), (unsigned long)(rate % 1000));
+    }
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        print_jitter(i);
+
+        const sensor_state_t *s = acq_sensor(i);
+        uint32_t rejected = 0;
+        for (int r = 0; r < SENSOR_REJ_COUNT; r++)
+            rejected += s->rejected[r];
+        if (rejected > 0)
+        {
+            char line[OUT_LINE_MAX];
+            size_t len = (size_t)snprintf(line, sizeof(line), "bordas rejeitadas %d:", i);
+            for (int r = 0; r < SENSOR_REJ_COUNT && len < sizeof(line); r++)
+                len += (size_t)snprintf(&line[len], sizeof(line) - len, " %s %lu%s",
+                                        sensor_reject_name((sensor_reject_t)r), (unsigned long)s->rejected[r],
+                                        r + 1 < SENSOR_REJ_COUNT ? "," : "");
+            out_printf("%s", line);
+        }
+
+        const median_filter_t *f = &app.filter[i];
+        if (median_filter_enabled(f))
+        {
+            out_printf("filtro %d: %lu de %lu medições descartadas", i, (unsigned long)f->outliers,
+                       (unsigned long)f->samples);
+        }
+        const kalman_t *k = &app.kalman[i];
+        if (kalman_enabled(k))
+        {
+            out_printf("kalman %d: %lu atualizações, %lu observações perdidas", i,
+                       (unsigned long)k->updates, (unsigned long)k->missed);
+        }
+        const deadband_t *d = &app.deadband[i];
+        if (deadband_enabled(d))
+        {
+            out_printf("deadband %d: %lu enviadas, %lu suprimidas", i, (unsigned long)d->sent,
+                       (unsigned long)d->suppressed);
+        }
+    }
+
+    meas_ring_t *ring = acq_ring();
+    out_printf("fila: %lu/%d máx, %lu descartes",
+               (unsigned long)atomic_load(&ring->high_water), MEAS_RING_SIZE,
+               (unsigned long)atomic_load(&ring->drops));
+
+    const out_stats_t *out = &app.out.stats;
+    out_printf("saída: %lu bytes enfileirados, %lu enviados, %lu descartados (%lu registros), "
+               "ocupação máx %lu/%d, latência máx %lu us",
+               (unsigned long)out->bytes_queued, (unsigned long)out->bytes_flushed,
+               (unsigned long)out->bytes_dropped, (unsigned long)out->records_dropped,
+               (unsigned long)out->high_water, OUT_RING_SIZE, (unsigned long)out->max_latency_us);
+
+    print_irq_stats();
+
+    const threshold_t *thr = acq_threshold();
+    const threshold_stats_t *ts = &thr->stats;
+    if (ts->count > 0)
+    {
+        out_printf("intertravamento: %lu avaliações, borda->pino %lu/%lu/%lu us (mín/média/máx), "
+                   "trigger->pino média %lu us, máx %lu us, %lu eventos perdidos",
+                   (unsigned long)ts->count, (unsigned long)ts->edge_min, (unsigned long)(ts->edge_sum / ts->count),
+                   (unsigned long)ts->edge_max, (unsigned long)(ts->trig_sum / ts->count), (unsigned long)ts->trig_max,
+                   (unsigned long)atomic_load(&thr->drops));
+    }
+
+    if (acq_trace_enabled())
+    {
+        out_printf("trace: %lu eventos perdidos", (unsigned long)atomic_load(&acq_trace()->drops));
+    }
+
+    const line_latency_t *lat = &app.cmd_latency;
+    if (lat->count > 0)
+    {
+        out_printf("comandos: %lu, latência média %lu us, máx %lu us, %lu bytes perdidos",
+                   (unsigned long)lat->count, (unsigned long)(lat->sum_us / lat->count),
+                   (unsigned long)lat->max_us, (unsigned long)atomic_load(&app.rx.overruns));
+    }
+}
+
+static bool cmd_start(int argc, const cmd_arg_t *argv)
+{
+    app.count_left = 0;
+    acq_set_running(true);
+    out_printf("Leitura iniciada!");
+    return true;
+}
+
+static bool cmd_stop(int argc, const cmd_arg_t *argv)
+{
+    acq_set_running(false);
+    out_printf("Leitura parada!");
+    return true;
+}
+
+// Ler não zera nada; 'stats reset' zera os contadores da aquisição no core1
+static bool cmd_stats(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0].w, "reset") != 0)
+            return false;
+        acq_reset_stats();
+        out_printf("Estatísticas zeradas");
+        return true;
+    }
+    print_stats();
+    return true;
+}
+
+static bool cmd_range(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0 && !acq_set_max_range(argv[0].u))
+        return false;
+    commands_print_range();
+    return true;
+}
+
+static bool cmd_timeout(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0 && (argv[0].u > ACQ_TIMEOUT_MAX_US / 1000 || !acq_set_echo_timeout(argv[0].u * 1000)))
+        return false;
+    commands_print_range();
+    return true;
+}
+
+static bool cmd_rate(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (argv[0].u < RATE_MIN_HZ || argv[0].u > RATE_MAX_HZ)
+            return false;
+        acq_set_interval(1000000u / argv[0].u);
+        if (acq_burst())
+            acq_set_burst(false, acq_burst_guard_us());
+    }
+    print_mode();
+    return true;
+}
+
+static bool cmd_count(int argc, const cmd_arg_t *argv)
+{
+    if (argc == 0)
+    {
+        out_printf("Medições restantes: %lu", (unsigned long)app.count_left);
+        return true;
+    }
+
+    // count_left 0 significa sem limite; para isso existe o start
+    if (argv[0].u == 0)
+        return false;
+
+    app.count_left = argv[0].u;
+    acq_set_running(true);
+    out_printf("Leitura iniciada, %lu medições", (unsigned long)app.count_left);
+    return true;
+}
+
+// Oversampling: N pings seguidos por leitura, um registro com a média
+static bool cmd_avg(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        uint32_t shots = 1;
+        if (strcmp(argv[0].w, "off") != 0 && !cmd_parse_uint(argv[0].w, &shots))
+            return false;
+        if (!acq_set_average(shots))
+            return false;
+    }
+    print_average();
+    return true;
+}
+
+static bool cmd_burst(int argc, const cmd_arg_t *argv)
+{
+    if (argc == 0)
+    {
+        acq_set_burst(true, acq_burst_guard_us());
+    }
+    else if (strcmp(argv[0].w, "off") == 0)
+    {
+        acq_set_burst(false, acq_burst_guard_us());
+    }
+    else
+    {
+        uint32_t guard_us;
+        if (!cmd_parse_uint(argv[0].w, &guard_us) || !acq_set_burst(true, guard_us))
+            return false;
+    }
+    print_mode();
+    return true;
+}
+
+static bool cmd_temp(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0].w, "auto") == 0)
+        {
+            app.temp_manual = false;
+            app_update_temperature(temp_sensor_read_deci());
+        }
+        else
+        {
+            int32_t deci;
+            if (!cmd_parse_deci(argv[0].w, &deci) || deci < SOUND_TEMP_MIN_DECI || deci > SOUND_TEMP_MAX_DECI)
+                return false;
+            app.temp_manual = true;
+            app_update_temperature(deci);
+        }
+    }
+    commands_print_temperature();
+    return true;
+}
+
+static bool cmd_format(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0].w, "text") == 0)
+            app.format = OUT_TEXT;
+        else if (strcmp(argv[0].w, "bin") == 0)
+            app.format = OUT_BIN;
+        else
+            return false;
+    }
+    out_printf("Formato: %s", app.format == OUT_BIN ? "bin" : "text");
+    return true;
+}
+
+static void print_filter(int sensor)
+{
+    const median_filter_t *f = &app.filter[sensor];
+    if (!median_filter_enabled(f))
+    {
+        out_printf("Filtro do sensor %d: off", sensor);
+        return;
+    }
+    out_printf("Filtro do sensor %d: mediana de %u, rejeição acima de %u.%u MAD", sensor, (unsigned)f->win.n,
+               (unsigned)(f->k_deci / 10), (unsigned)(f->k_deci % 10));
+}
+
+// Mediana móvel com rejeição por MAD, por sensor
+static bool cmd_filter(int argc, const cmd_arg_t *argv)
+{
+    if (argc == 0)
+    {
+        for (int i = 0; i < SENSOR_COUNT; i++)
+            print_filter(i);
+        return true;
+    }
+
+    uint32_t sensor = argv[0].u;
+    if (sensor >= SENSOR_COUNT)
+        return false;
+
+    if (argc > 1)
+    {
+        uint32_t window = 0;
+        if (strcmp(argv[1].w, "off") != 0 && !cmd_parse_uint(argv[1].w, &window))
+            return false;
+        if (window > MEDIAN_MAX_WINDOW)
+            return false;
+
+        int32_t k_deci = argc > 2 ? argv[2].i : MEDIAN_K_DECI_DEFAULT;
+        if (k_deci < 1 || k_deci > 1000)
+            return false;
+        median_filter_init(&app.filter[sensor], (uint8_t)window, (uint16_t)k_deci);
+    }
+    print_filter((int)sensor);
+    return true;
+}
+
+static void print_kalman(int sensor)
+{
+    const kalman_t *k = &app.kalman[sensor];
+    if (!kalman_enabled(k))
+    {
+        out_printf("Kalman do sensor %d: off", sensor);
+        return;
+    }
+    out_printf("Kalman do sensor %d: ruído %lu.%lu mm, aceleração %lu mm/s2", sensor,
+               (unsigned long)(k->noise_um / 1000), (unsigned long)(k->noise_um / 100 % 10),
+               (unsigned long)(k->accel_um_s2 / 1000));
+}
+
+// Rastreador de distância e velocidade, por sensor. Ruído da medição em mm
+// (uma casa) e aceleração aleatória do alvo em mm/s^2.
+static bool cmd_kalman(int argc, const cmd_arg_t *argv)
+{
+    if (argc == 0)
+    {
+        for (int i = 0; i < SENSOR_COUNT; i++)
+            print_kalman(i);
+        return true;
+    }
+
+    uint32_t sensor = argv[0].u;
+    if (sensor >= SENSOR_COUNT)
+        return false;
+
+    if (argc > 1)
+    {
+        int32_t noise_deci = 0;
+        if (strcmp(argv[1].w, "off") != 0 && (!cmd_parse_deci(argv[1].w, &noise_deci) || noise_deci < 1))
+            return false;
+        if (noise_deci > KALMAN_NOISE_MAX_UM / 100)
+            return false;
+
+        uint32_t accel = argc > 2 ? argv[2].u : KALMAN_ACCEL_UM_S2_DEFAULT / 1000;
+        if (accel < 1 || accel > KALMAN_ACCEL_MAX_UM_S2 / 1000)
+            return false;
+        kalman_init(&app.kalman[sensor], (uint32_t)noise_deci * 100, accel * 1000);
+    }
+    print_kalman((int)sensor);
+    return true;
+}
+
+static void print_deadband(void)
+{
+    const deadband_t *d = &app.deadband[0];
+    if (!deadband_enabled(d))
+    {
+        out_printf("Deadband: off");
+        return;
+    }
+    out_printf("Deadband: %lu.%lu mm, heartbeat %lu ms", (unsigned long)(d->band_um / 1000),
+               (unsigned long)(d->band_um / 100 % 10), (unsigned long)(d->heartbeat_us / 1000));
+}
+
+// Relatório só na mudança, em todos os sensores: faixa morta em mm (uma
+// casa) e maior silêncio entre registros
+static bool cmd_deadband(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        int32_t band_deci = 0;
+        if (strcmp(argv[0].w, "off") != 0 && (!cmd_parse_deci(argv[0].w, &band_deci) || band_deci < 1))
+            return false;
+        if (band_deci > 100000)
+            return false;
+
+        uint32_t heartbeat_ms = argc > 1 ? argv[1].u : DEADBAND_HEARTBEAT_MS;
+        if (heartbeat_ms < 1 || heartbeat_ms > 3600000)
+            return false;
+        for (int i = 0; i < SENSOR_COUNT; i++)
+            deadband_init(&app.deadband[i], (uint32_t)band_deci * 100, heartbeat_ms);
+    }
+    print_deadband();
+    return true;
+}
+
+static void print_threshold(void)
+{
+    threshold_t *t = acq_threshold();
+    if (!threshold_enabled(t))
+    {
+        out_printf("Intertravamento: off");
+        return;
+    }
+    out_printf("Intertravamento: perto abaixo de %lu mm, longe acima de %lu mm ou após %lu timeouts seguidos, "
+               "saída no GPIO %d",
+               (unsigned long)threshold_near_mm(t), (unsigned long)threshold_far_mm(t),
+               (unsigned long)threshold_release_timeouts(t), THRESHOLD_OUT_PIN);
+}
+
+// Caminho das IRQs de borda; 'stats' compara os ciclos dos dois
+static bool cmd_irq(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        int mode = -1;
+        for (int m = 0; m < ACQ_IRQ_MODES; m++)
+        {
+            if (strcmp(argv[0].w, irq_mode_names[m]) == 0)
+                mode = m;
+        }
+        if (mode < 0 || !acq_set_irq_mode((acq_irq_mode_t)mode))
+            return false;
+        acq_reset_stats();
+    }
+    print_irq_mode();
+    return true;
+}
+
+// Limiares do intertravamento, com histerese entre perto e longe
+static bool cmd_threshold(int argc, const cmd_arg_t *argv)
+{
+    if (argc == 1)
+    {
+        if (strcmp(argv[0].w, "off") != 0)
+            return false;
+        threshold_set(acq_threshold(), 0, 0, threshold_release_timeouts(acq_threshold()));
+    }
+    else if (argc >= 2)
+    {
+        uint32_t near_mm;
+        if (!cmd_parse_uint(argv[0].w, &near_mm) || near_mm < 1 || argv[1].u > SENSOR_RANGE_LIMIT_MM)
+            return false;
+        uint32_t release = argc > 2 ? argv[2].u : THRESHOLD_RELEASE_TIMEOUTS;
+        if (!threshold_set(acq_threshold(), near_mm, argv[1].u, release))
+            return false;
+    }
+    print_threshold();
+    return true;
+}
+
+// Política da fila de saída quando o host não lê a tempo
+static bool cmd_drop(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0].w, "newest") == 0)
+            app.out.policy = OUT_DROP_NEWEST;
+        else if (strcmp(argv[0].w, "oldest") == 0)
+            app.out.policy = OUT_DROP_OLDEST;
+        else
+            return false;
+    }
+    out_printf("Fila cheia descarta: %s", app.out.policy == OUT_DROP_OLDEST ? "oldest" : "newest");
+    return true;
+}
+
+// Âncora da hora UTC: segundos Unix no instante em que a linha chegou. A hora
+// de cada medição passa a ser derivada do relógio monotônico sem ler o RTC.
+static bool cmd_settime(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        uint64_t now = hal_time_us();
+        uint64_t t_rx = now - (uint32_t)((uint32_t)now - app.line.t_end_us);
+        app.epoch_offset_us = (int64_t)argv[0].u * 1000000 - (int64_t)t_rx;
+        app.epoch_set = true;
+    }
+
+    if (!app.epoch_set)
+    {
+        out_printf("Hora não definida, medições em segundos desde o boot");
+        return true;
+    }
+    uint64_t now = hal_time_us() + (uint64_t)app.epoch_offset_us;
+    out_printf("Hora: %llu.%06lu (Unix)", (unsigned long long)(now / 1000000),
+               (unsigned long)(now % 1000000));
+    return true;
+}
+
+// Grava trigger, bordas e timeouts de cada medição e os envia em quadros
+// binários, para reprodução no host (host/replay.c). Liga também a saída
+// binária.
+static bool cmd_trace(int argc, const cmd_arg_t *argv)
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0].w, "on") == 0)
+        {
+            app.format = OUT_BIN;
+            acq_set_trace(true);
+        }
+        else if (strcmp(argv[0].w, "off") == 0)
+            acq_set_trace(false);
+        else
+            return false;
+    }
+    out_printf("Trace: %s", acq_trace_enabled() ? "on" : "off");
+    return true;
+}
+
+// Custo de gerar a saída de uma medição em cada formato, sem enviar nada
+static bool cmd_bench(int argc, const cmd_arg_t *argv)
+{
+    const uint32_t n = 1000;
+    measurement_t m = {.t_descida = hal_time_us(), .seq = 0, .pulse_us = 5831, .distance_um = 1000000};
+    volatile size_t bin_len = 0;
+    volatile int text_len = 0;
+
+    uint64_t t0 = hal_time_us();
+    for (uint32_t i = 0; i < n; i++, m.seq++)
+    {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        uint8_t frame[FRAME_MAX_ENCODED];
+        bin_len = frame_encode(payload, frame_pack_measurement(&m, payload), frame);
+    }
+    uint64_t t_bin = hal_time_us() - t0;
+
+    t0 = hal_time_us();
+    for (uint32_t i = 0; i < n; i++, m.seq++)
+    {
+        char cm[DISTANCE_CM_STR_MAX];
+        char line[48];
+        distance_format_cm(cm, m.distance_um);
+        text_len = snprintf(line, sizeof(line), "%lu.%06lu - %s cm\n", (unsigned long)(m.t_descida / 1000000),
+                            (unsigned long)(m.t_descida % 1000000), cm);
+    }
+    uint64_t t_text = hal_time_us() - t0;
+
+    kalman_t k;
+    kalman_init(&k, KALMAN_NOISE_UM_DEFAULT, KALMAN_ACCEL_UM_S2_DEFAULT);
+    t0 = hal_time_us();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m.t_descida += 20000;
+        m.distance_um = 1000000 + (i & 7) * 1000;
+        m.status = MEAS_OK;
+        kalman_apply(&k, &m);
+    }
+    uint64_t t_kalman = hal_time_us() - t0;
+
+    out_printf("saída por medição: bin %lu ns (%lu bytes), text %lu ns (%d bytes)",
+               (unsigned long)(t_bin * 1000 / n), (unsigned long)bin_len,
+               (unsigned long)(t_text * 1000 / n), text_len);
+    out_printf("kalman: %lu ns por atualização", (unsigned long)(t_kalman * 1000 / n));
+    return true;
+}
+
+static bool cmd_help(int argc, const cmd_arg_t *argv);
+
+// Em ordem alfabética: a busca é binária
+static const cmd_def_t commands[] = {
+    {"avg", cmd_avg, "w", 0, "[n|off]"},
+    {"bench", cmd_bench, "", 0, ""},
+    {"burst", cmd_burst, "w", 0, "[guarda_us|off]"},
+    {"count", cmd_count, "u", 0, "[n]"},
+    {"deadband", cmd_deadband, "wu", 0, "[mm|off] [heartbeat_ms]"},
+    {"drop", cmd_drop, "w", 0, "[newest|oldest]"},
+    {"filter", cmd_filter, "uwd", 0, "[sensor] [janela|off] [k]"},
+    {"format", cmd_format, "w", 0, "[text|bin]"},
+    {"help", cmd_help, "", 0, ""},
+    {"irq", cmd_irq, "w", 0, "[sdk|raw]"},
+    {"kalman", cmd_kalman, "uwu", 0, "[sensor] [ruido_mm|off] [acel_mm_s2]"},
+    {"range", cmd_range, "u", 0, "[mm]"},
+    {"rate", cmd_rate, "u", 0, "[hz]"},
+    {"settime", cmd_settime, "u", 0, "[segundos_unix]"},
+    {"start", cmd_start, "", 0, ""},
+    {"stats", cmd_stats, "w", 0, "[reset]"},
+    {"stop", cmd_stop, "", 0, ""},
+    {"temp", cmd_temp, "w", 0, "[C|auto]"},
+    {"threshold", cmd_threshold, "wuu", 0, "[perto_mm longe_mm [timeouts]|off]"},
+    {"timeout", cmd_timeout, "u", 0, "[ms]"},
+    {"trace", cmd_trace, "w", 0, "[on|off]"},
+};
+
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+// Largura das linhas do help, quebradas entre comandos
+#define HELP_WIDTH 96
+
+void commands_print_help(void)
+{
+    char line[OUT_LINE_MAX];
+    size_t len = (size_t)snprintf(line, sizeof(line), "Comandos:");
+    for (size_t i = 0; i < COMMAND_COUNT; i++)
+    {
+        char item[64];
+        size_t n = (size_t)snprintf(item, sizeof(item), " %s%s%s%s", commands[i].name,
+                                    commands[i].usage[0] ? " " : "", commands[i].usage,
+                                    i + 1 < COMMAND_COUNT ? "," : "");
+        if (len + n > HELP_WIDTH)
+        {
+            out_printf("%s", line);
+            len = 0;
+        }
+        memcpy(&line[len], item, n + 1);
+        len += n;
+    }
+    out_printf("%s", line);
+}
+
+static bool cmd_help(int argc, const cmd_arg_t *argv)
+{
+    commands_print_help();
+    return true;
+}
+
+void commands_init(void)
+{
+    assert(cmd_table_sorted(commands, COMMAND_COUNT));
+}
+
+void commands_execute(char *line)
+{
+    const cmd_def_t *cmd;
+    switch (cmd_execute(commands, COMMAND_COUNT, line, &cmd))
+    {
+    case CMD_OK:
+    case CMD_EMPTY:
+        break;
+    case CMD_UNKNOWN:
+        out_printf("Comando desconhecido. Digite 'help' para a lista.");
+        break;
+    case CMD_BAD_ARGS:
+    case CMD_REJECTED:
+        out_printf("Uso: %s %s", cmd->name, cmd->usage);
+        break;
+    }
+}
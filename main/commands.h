@@ -0,0 +1,15 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+// Tabela de comandos do firmware e seus handlers
+
+void commands_init(void);
+
+// Executa uma linha recebida. A linha é modificada.
+void commands_execute(char *line);
+
+void commands_print_help(void);
+void commands_print_range(void);
+void commands_print_temperature(void);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Configuração de compilação do firmware. Os valores podem ser
+// sobrescritos com -D (ex.: via target_compile_definitions).
+
+// Quantidade máxima de sensores suportada pelas tabelas
+#define SENSOR_MAX 8
+
+// Quantidade de sensores ligados à placa
+#ifndef SENSOR_COUNT
+#define SENSOR_COUNT 1
+#endif
+
+#if SENSOR_COUNT < 1 || SENSOR_COUNT > SENSOR_MAX
+#error "SENSOR_COUNT deve estar entre 1 e SENSOR_MAX"
+#endif
+
+// Pinos { TRIG, ECHO } de cada sensor, na ordem de disparo
+#define SENSOR_PIN_TABLE \
+    {                    \
+        {15, 14},        \
+        {13, 12},        \
+        {11, 10},        \
+        {9, 8},          \
+        {7, 6},          \
+        {5, 4},          \
+        {3, 2},          \
+        {17, 16},        \
+    }
+
+// Intervalo mínimo entre duas medições do mesmo sensor
+#ifndef MEASUREMENT_INTERVAL_MS
+#define MEASUREMENT_INTERVAL_MS 1000
+#endif
+
+// Silêncio entre o fim de um echo e o próximo trigger, para que ecos
+// atrasados de um sensor não sejam lidos pelo seguinte
+#ifndef SENSOR_GUARD_US
+#define SENSOR_GUARD_US 10000
+#endif
+
+// Alcance máximo padrão, usado para calcular o timeout do echo. Pode ser
+// alterado em tempo de execução com o comando 'range'.
+#ifndef SENSOR_MAX_RANGE_MM
+#define SENSOR_MAX_RANGE_MM 4000
+#endif
+
+// Limites aceitos pelo comando 'range'
+#define SENSOR_RANGE_MIN_MM 20
+#define SENSOR_RANGE_LIMIT_MM 10000
+
+// Modo burst: tempo de guarda padrão entre o fim de um echo e o próximo
+// trigger (ringdown do transdutor) e período do relatório de taxa
+#ifndef BURST_GUARD_US
+#define BURST_GUARD_US 5000
+#endif
+
+#ifndef BURST_REPORT_MS
+#define BURST_REPORT_MS 1000
+#endif
+
+// Período de leitura do sensor de temperatura interno, usado para
+// compensar a velocidade do som
+#ifndef TEMP_UPDATE_MS
+#define TEMP_UPDATE_MS 2000
+#endif
+
+// Período do tick que acorda o loop principal para tarefas por tempo
+// (temperatura, relatório do burst)
+#ifndef MAIN_TICK_MS
+#define MAIN_TICK_MS 100
+#endif
+
+// Máximo de bytes da fila de saída enviados por vez quando o stdio não
+// informa quanto aceita sem bloquear (UART)
+#ifndef OUT_DRAIN_CHUNK
+#define OUT_DRAIN_CHUNK 256
+#endif
+
+// Modo trace: eventos acumulados antes de montar um quadro, e maior espera
+// de um evento no anel
+#ifndef TRACE_BATCH_EVENTS
+#define TRACE_BATCH_EVENTS 16
+#endif
+
+#ifndef TRACE_FLUSH_MS
+#define TRACE_FLUSH_MS 100
+#endif
+
+// Oversampling ('avg'): maior número de pings agregados num registro
+#ifndef AVG_MAX_SHOTS
+#define AVG_MAX_SHOTS 64
+#endif
+
+#endif
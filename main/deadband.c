@@ -0,0 +1,36 @@
+#include "deadband.h"
+
+void deadband_init(deadband_t *d, uint32_t band_um, uint32_t heartbeat_ms)
+{
+    d->band_um = band_um;
+    d->heartbeat_us = heartbeat_ms * 1000;
+    d->has_last = false;
+    d->sent = 0;
+    d->suppressed = 0;
+}
+
+bool deadband_pass(deadband_t *d, const measurement_t *m)
+{
+    if (!deadband_enabled(d))
+        return true;
+
+    bool send = !d->has_last || m->status != d->last_status || m->t_descida - d->last_t >= d->heartbeat_us;
+    if (!send && m->status == MEAS_OK)
+    {
+        uint32_t delta = m->distance_um > d->last_um ? m->distance_um - d->last_um : d->last_um - m->distance_um;
+        send = delta > d->band_um;
+    }
+
+    if (!send)
+    {
+        d->suppressed++;
+        return false;
+    }
+
+    d->has_last = true;
+    d->last_status = m->status;
+    d->last_um = m->distance_um;
+    d->last_t = m->t_descida;
+    d->sent++;
+    return true;
+}
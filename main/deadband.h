@@ -0,0 +1,42 @@
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "measurement.h"
+
+// Relatório só na mudança: uma medição é enviada quando a distância (já
+// filtrada) sai da faixa morta em torno da última enviada, quando o status
+// muda (válida, falha, descartada) ou quando passa o intervalo máximo de
+// silêncio (heartbeat). As demais são contadas e descartadas.
+
+// Heartbeat padrão, em ms
+#ifndef DEADBAND_HEARTBEAT_MS
+#define DEADBAND_HEARTBEAT_MS 10000
+#endif
+
+typedef struct
+{
+    uint32_t band_um;      // 0 = desligado, tudo é enviado
+    uint32_t heartbeat_us;
+    bool has_last;
+    uint8_t last_status;
+    uint32_t last_um;
+    uint64_t last_t; // instante da última enviada
+
+    uint32_t sent;
+    uint32_t suppressed;
+} deadband_t;
+
+void deadband_init(deadband_t *d, uint32_t band_um, uint32_t heartbeat_ms);
+
+static inline bool deadband_enabled(const deadband_t *d)
+{
+    return d->band_um > 0;
+}
+
+// Retorna true se a medição deve ser enviada
+bool deadband_pass(deadband_t *d, const measurement_t *m);
+
+#endif
@@ -0,0 +1,41 @@
+#include "distance.h"
+
+#include "hal.h"
+
+uint32_t distance_k_q8(uint32_t sound_speed_mm_s)
+{
+    // (mm/s / 1000) / 2 * 256 = mm/s * 16 / 125
+    return (uint32_t)(((uint64_t)sound_speed_mm_s * 16u + 62u) / 125u);
+}
+
+// Chamada também da IRQ da descida (intertravamento)
+uint32_t HAL_ISR_FUNC(distance_um)(uint32_t pulse_us, uint32_t k_q8)
+{
+    // k < 2^16 para qualquer velocidade plausível, então pulsos abaixo de
+    // 65 ms cabem numa multiplicação de 32 bits (o M0+ não tem 32x32->64)
+    if (pulse_us < 0x10000u && k_q8 < 0x10000u)
+        return (pulse_us * k_q8) >> DISTANCE_K_FRAC_BITS;
+
+    return (uint32_t)(((uint64_t)pulse_us * k_q8) >> DISTANCE_K_FRAC_BITS);
+}
+
+size_t distance_format_cm(char *buf, uint32_t distance_um)
+{
+    // Centésimos de cm = dezenas de um
+    uint32_t centi = (distance_um + 50u) / 100u;
+
+    char tmp[DISTANCE_CM_STR_MAX];
+    size_t n = 0;
+    do
+    {
+        tmp[n++] = (char)('0' + centi % 10u);
+        centi /= 10u;
+        if (n == 2)
+            tmp[n++] = '.';
+    } while (centi > 0 || n < 4);
+
+    for (size_t i = 0; i < n; i++)
+        buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
@@ -0,0 +1,29 @@
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Conversão da largura do echo em distância só com inteiros. O fator k é
+// metade da velocidade do som em um/us, em Q8: d_um = (pulse_us * k) >> 8.
+
+#define DISTANCE_K_FRAC_BITS 8
+
+// 343 m/s -> 171,5 um/us -> 43904 em Q8 (o mesmo que 0.0343f / 2 em cm)
+#define DISTANCE_K_Q8_DEFAULT 43904u
+
+// Maior texto gerado por distance_format_cm(), com o '\0'
+#define DISTANCE_CM_STR_MAX 16
+
+// Fator k para uma velocidade do som em mm/s
+uint32_t distance_k_q8(uint32_t sound_speed_mm_s);
+
+// Distância em micrômetros para um pulso em us. Trunca, para que o
+// arredondamento para centésimos de cm em distance_format_cm() decida igual
+// ao valor exato (as fronteiras caem em um inteiros).
+uint32_t distance_um(uint32_t pulse_us, uint32_t k_q8);
+
+// Escreve a distância em cm com duas casas ("123.45") e retorna o tamanho
+size_t distance_format_cm(char *buf, uint32_t distance_um);
+
+#endif
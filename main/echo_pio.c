@@ -0,0 +1,54 @@
+#include "echo_pio.h"
+
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+
+#include "hal.h"
+
+#include "hcsr04.pio.h"
+
+// IRQs de PIO que já têm o handler instalado
+static uint32_t installed_irqs;
+
+bool echo_pio_init(echo_pio_t *ch, uint trig_pin, uint echo_pin, irq_handler_t handler)
+{
+    if (!pio_claim_free_sm_and_add_program(&hcsr04_program, &ch->pio, &ch->sm, &ch->offset))
+        return false;
+
+    ch->clk_hz = clock_get_hz(clk_sys);
+    hcsr04_program_init(ch->pio, ch->sm, ch->offset, trig_pin, echo_pin);
+
+    // Vários canais na mesma PIO compartilham a IRQ; o handler é instalado uma vez
+    uint irq_num = pio_get_irq_num(ch->pio, 0);
+    pio_set_irq0_source_enabled(ch->pio, pio_get_rx_fifo_not_empty_interrupt_source(ch->sm), true);
+    if (!(installed_irqs & (1u << irq_num)))
+    {
+        irq_add_shared_handler(irq_num, handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq_num, true);
+        installed_irqs |= 1u << irq_num;
+    }
+    return true;
+}
+
+void echo_pio_trigger(echo_pio_t *ch, uint32_t timeout_us)
+{
+    uint32_t trig_cycles = ECHO_PIO_TRIGGER_US * (ch->clk_hz / 1000000u);
+    pio_sm_put_blocking(ch->pio, ch->sm, trig_cycles);
+    pio_sm_put_blocking(ch->pio, ch->sm, echo_pio_budget(timeout_us, ch->clk_hz));
+}
+
+// Chamada de dentro da IRQ da PIO
+bool HAL_ISR_FUNC(echo_pio_read)(echo_pio_t *ch, echo_pio_sample_t *out)
+{
+    if (pio_sm_is_rx_fifo_empty(ch->pio, ch->sm))
+        return false;
+
+    // As duas palavras são empurradas com 2 ciclos de diferença
+    uint32_t rise_word = pio_sm_get_blocking(ch->pio, ch->sm);
+    uint32_t end_word = pio_sm_get_blocking(ch->pio, ch->sm);
+
+    out->width_cycles = 0;
+    out->status = echo_pio_decode(rise_word, end_word, &out->width_cycles);
+    out->width_us = echo_pio_cycles_to_us(out->width_cycles, ch->clk_hz);
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef ECHO_PIO_H
+#define ECHO_PIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/pio.h"
+
+#include "echo_pio_proto.h"
+
+// Duração do pulso de trigger do HC-SR04
+#define ECHO_PIO_TRIGGER_US 10
+
+// Um canal de captura: uma state machine ligada a um par TRIG/ECHO
+typedef struct
+{
+    PIO pio;
+    uint sm;
+    uint offset;
+    uint32_t clk_hz;
+} echo_pio_t;
+
+// Uma medição lida da RX FIFO
+typedef struct
+{
+    echo_pio_status_t status;
+    uint32_t width_cycles;
+    uint32_t width_us;
+} echo_pio_sample_t;
+
+// Carrega o programa numa PIO livre e configura a SM. O handler é chamado
+// na IRQ de "RX FIFO não vazia" e deve atender todos os canais.
+bool echo_pio_init(echo_pio_t *ch, uint trig_pin, uint echo_pin, irq_handler_t handler);
+
+// Gera o trigger e arma a contagem, com o timeout dado
+void echo_pio_trigger(echo_pio_t *ch, uint32_t timeout_us);
+
+// Lê uma medição da RX FIFO, se houver. Não bloqueia.
+bool echo_pio_read(echo_pio_t *ch, echo_pio_sample_t *out);
+
+#endif
@@ -0,0 +1,60 @@
+#include "echo_pio_proto.h"
+
+#include "hal.h"
+
+uint32_t echo_pio_budget(uint32_t timeout_us, uint32_t clk_hz)
+{
+    uint64_t iters = (uint64_t)timeout_us * (clk_hz / 1000000u) / ECHO_PIO_CYCLES_PER_ITER;
+    return iters > ECHO_PIO_MAX_BUDGET ? ECHO_PIO_MAX_BUDGET : (uint32_t)iters;
+}
+
+echo_pio_status_t HAL_ISR_FUNC(echo_pio_decode)(uint32_t rise_word, uint32_t end_word, uint32_t *width_cycles)
+{
+    if (rise_word == ECHO_PIO_NO_RISE)
+        return ECHO_PIO_NO_ECHO;
+
+    // x só fica maior que y se deu a volta: orçamento estourou em nível alto
+    if (end_word > rise_word)
+        return ECHO_PIO_STUCK_HIGH;
+
+    *width_cycles = (rise_word - end_word) * ECHO_PIO_CYCLES_PER_ITER;
+    return ECHO_PIO_OK;
+}
+
+uint32_t HAL_ISR_FUNC(echo_pio_cycles_to_us)(uint32_t cycles, uint32_t clk_hz)
+{
+    uint32_t per_us = clk_hz / 1000000u;
+    return (cycles + per_us / 2) / per_us;
+}
+
+void echo_pio_model(uint32_t budget, uint32_t rise_iter, uint32_t high_iters, uint32_t out[2])
+{
+    // Reproduz instrução a instrução os laços wait_rise/echo_hi
+    uint32_t x = budget;
+    uint32_t y = ECHO_PIO_NO_RISE;
+    uint32_t i = 0;
+
+    for (;;)
+    {
+        if (i >= rise_iter) // jmp pin rise
+        {
+            y = x;
+            uint32_t h = 0;
+            for (;;)
+            {
+                if (h >= high_iters) // jmp pin still_hi (não tomado)
+                    break;
+                h++;
+                if (x-- == 0) // jmp x-- echo_hi
+                    break;
+            }
+            break;
+        }
+        i++;
+        if (x-- == 0) // jmp x-- wait_rise
+            break;
+    }
+
+    out[0] = y;
+    out[1] = x;
+}
@@ -0,0 +1,41 @@
+#ifndef ECHO_PIO_PROTO_H
+#define ECHO_PIO_PROTO_H
+
+#include <stdint.h>
+
+// Protocolo do contador de echo do programa hcsr04.pio. Não depende do SDK
+// para que a decodificação possa ser exercitada no host.
+
+// Cada iteração dos laços de espera/contagem gasta 2 instruções
+#define ECHO_PIO_CYCLES_PER_ITER 2u
+
+// Marca "sem subida" deixada em y pelo programa
+#define ECHO_PIO_NO_RISE 0xFFFFFFFFu
+
+// Maior orçamento aceito: precisa ser menor que ECHO_PIO_NO_RISE para que o
+// estouro em nível alto (x dá a volta) seja distinguível
+#define ECHO_PIO_MAX_BUDGET 0xFFFFFFFEu
+
+typedef enum
+{
+    ECHO_PIO_OK = 0,
+    ECHO_PIO_NO_ECHO,    // o echo não subiu dentro do orçamento
+    ECHO_PIO_STUCK_HIGH, // o echo subiu mas não desceu dentro do orçamento
+} echo_pio_status_t;
+
+// Converte um timeout em us para o orçamento de iterações do programa
+uint32_t echo_pio_budget(uint32_t timeout_us, uint32_t clk_hz);
+
+// Decodifica o par (y, x) lido da RX FIFO. Em ECHO_PIO_OK devolve a largura
+// do echo em ciclos de clock do sistema.
+echo_pio_status_t echo_pio_decode(uint32_t rise_word, uint32_t end_word, uint32_t *width_cycles);
+
+// Converte ciclos em us, arredondando
+uint32_t echo_pio_cycles_to_us(uint32_t cycles, uint32_t clk_hz);
+
+// Modelo do programa PIO: dado o orçamento, em quantas iterações o echo
+// sobe (UINT32_MAX = nunca) e por quantas iterações fica alto
+// (UINT32_MAX = preso), produz as duas palavras que a SM empurraria.
+void echo_pio_model(uint32_t budget, uint32_t rise_iter, uint32_t high_iters, uint32_t out[2]);
+
+#endif
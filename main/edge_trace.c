@@ -0,0 +1,153 @@
+#include "edge_trace.h"
+
+#include "frame.h"
+#include "hal.h"
+
+void edge_trace_init(edge_trace_t *t)
+{
+    atomic_store_explicit(&t->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->drops, 0, memory_order_relaxed);
+}
+
+bool HAL_ISR_FUNC(edge_trace_push)(edge_trace_t *t, uint32_t t_us, uint8_t pin, trace_kind_t kind)
+{
+    uint32_t head = atomic_load_explicit(&t->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&t->tail, memory_order_acquire);
+    if (head - tail >= EDGE_TRACE_SIZE)
+    {
+        atomic_store_explicit(&t->drops, atomic_load_explicit(&t->drops, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    t->ev[head & (EDGE_TRACE_SIZE - 1)] = (trace_event_t){t_us, pin, (uint8_t)kind};
+    atomic_store_explicit(&t->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool edge_trace_pop(edge_trace_t *t, trace_event_t *out)
+{
+    uint32_t tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&t->head, memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    *out = t->ev[tail & (EDGE_TRACE_SIZE - 1)];
+    atomic_store_explicit(&t->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t edge_trace_count(edge_trace_t *t)
+{
+    return atomic_load_explicit(&t->head, memory_order_acquire) - atomic_load_explicit(&t->tail, memory_order_acquire);
+}
+
+static size_t varint_len(uint64_t v)
+{
+    size_t n = 1;
+    while (v >= 0x80)
+    {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+size_t edge_trace_pack(edge_trace_t *t, uint8_t *payload, size_t max)
+{
+    uint32_t tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&t->head, memory_order_acquire);
+    if (tail == head || max <= TRACE_HEADER_LEN)
+        return 0;
+
+    uint32_t t0 = t->ev[tail & (EDGE_TRACE_SIZE - 1)].t_us;
+    uint16_t drops = (uint16_t)atomic_load_explicit(&t->drops, memory_order_relaxed);
+    uint8_t *p = payload;
+    *p++ = FRAME_TYPE_TRACE;
+    for (int i = 0; i < 4; i++)
+        *p++ = (uint8_t)(t0 >> (8 * i));
+    *p++ = (uint8_t)drops;
+    *p++ = (uint8_t)(drops >> 8);
+
+    uint32_t last = t0;
+    for (; tail != head; tail++)
+    {
+        const trace_event_t *ev = &t->ev[tail & (EDGE_TRACE_SIZE - 1)];
+        int32_t delta = (int32_t)(ev->t_us - last);
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        uint64_t v = ((uint64_t)zigzag << 7) | ((uint64_t)(ev->pin & 0x1f) << 2) | (ev->kind & 3);
+        if ((size_t)(p - payload) + varint_len(v) > max)
+            break;
+
+        while (v >= 0x80)
+        {
+            *p++ = (uint8_t)(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = (uint8_t)v;
+        last = ev->t_us;
+    }
+    atomic_store_explicit(&t->tail, tail, memory_order_release);
+    return (size_t)(p - payload);
+}
+
+void trace_decoder_init(trace_decoder_t *d)
+{
+    d->started = false;
+    d->last_us = 0;
+    d->t_us = 0;
+    d->drops = 0;
+    d->lost = 0;
+}
+
+int trace_unpack(trace_decoder_t *d, const uint8_t *payload, size_t len, trace_record_t *out, size_t max)
+{
+    if (len < TRACE_HEADER_LEN || payload[0] != FRAME_TYPE_TRACE)
+        return -1;
+
+    uint32_t t0 = payload[1] | (payload[2] << 8) | (payload[3] << 16) | ((uint32_t)payload[4] << 24);
+    uint16_t drops = (uint16_t)(payload[5] | (payload[6] << 8));
+
+    // Entre quadros o tempo avança pela diferença de 32 bits (com sinal),
+    // que cobre até ~35 min sem eventos
+    if (d->started)
+    {
+        d->t_us += (int64_t)(int32_t)(t0 - d->last_us);
+        d->lost += (uint16_t)(drops - d->drops);
+    }
+    else
+    {
+        d->t_us = t0;
+        d->started = true;
+    }
+    d->last_us = t0;
+    d->drops = drops;
+
+    const uint8_t *p = payload + TRACE_HEADER_LEN;
+    const uint8_t *end = payload + len;
+    int n = 0;
+    while (p < end)
+    {
+        uint64_t v = 0;
+        int shift = 0;
+        uint8_t b;
+        do
+        {
+            if (p == end || shift > 56)
+                return -1;
+            b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        if ((size_t)n == max)
+            return -1;
+        uint32_t zigzag = (uint32_t)(v >> 7);
+        int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+        d->t_us += (int64_t)delta;
+        d->last_us += (uint32_t)delta;
+        out[n++] = (trace_record_t){d->t_us, (uint8_t)((v >> 2) & 0x1f), (uint8_t)(v & 3)};
+    }
+    return n;
+}
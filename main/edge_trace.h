@@ -0,0 +1,89 @@
+#ifndef EDGE_TRACE_H
+#define EDGE_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Registro bruto dos eventos da aquisição (trigger, bordas do echo,
+// timeouts) para reproduzir leituras ruins fora da placa. As IRQs do core1
+// gravam num anel em RAM; o core0 empacota os eventos em quadros
+// FRAME_TYPE_TRACE com tempos em delta, e o host os reproduz pela mesma
+// máquina de estados (host/replay.c).
+//
+// Payload de um quadro: tipo u8, t0 u32 (instante do primeiro evento, us),
+// descartes u16 (acumulado, módulo 2^16), e um varint LEB128 por evento
+// com (zigzag(delta_us) << 7) | (pino << 2) | tipo. O delta tem sinal: o
+// trigger é gravado fora de IRQ e pode entrar no anel depois de uma borda
+// de outro sensor um pouco posterior.
+
+// Capacidade do anel (potência de 2)
+#ifndef EDGE_TRACE_SIZE
+#define EDGE_TRACE_SIZE 256
+#endif
+
+#if (EDGE_TRACE_SIZE & (EDGE_TRACE_SIZE - 1)) != 0
+#error "EDGE_TRACE_SIZE deve ser potência de 2"
+#endif
+
+#define TRACE_HEADER_LEN 7
+
+typedef enum
+{
+    TRACE_TRIG = 0, // fim do trigger (pino TRIG)
+    TRACE_RISE,     // subida do echo (pino ECHO)
+    TRACE_FALL,     // descida do echo
+    TRACE_TIMEOUT,  // alarme de timeout (pino ECHO)
+} trace_kind_t;
+
+typedef struct
+{
+    uint32_t t_us;
+    uint8_t pin;
+    uint8_t kind; // trace_kind_t
+} trace_event_t;
+
+// Anel de um produtor (o core1; quem grava fora de IRQ desliga as IRQs) e
+// um consumidor (core0)
+typedef struct
+{
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t drops;
+    trace_event_t ev[EDGE_TRACE_SIZE];
+} edge_trace_t;
+
+void edge_trace_init(edge_trace_t *t);
+bool edge_trace_push(edge_trace_t *t, uint32_t t_us, uint8_t pin, trace_kind_t kind);
+bool edge_trace_pop(edge_trace_t *t, trace_event_t *out);
+uint32_t edge_trace_count(edge_trace_t *t);
+
+// Tira eventos do anel e monta um payload de até max bytes. Retorna 0 se
+// não havia eventos.
+size_t edge_trace_pack(edge_trace_t *t, uint8_t *payload, size_t max);
+
+// Evento decodificado, com o tempo estendido para 64 bits
+typedef struct
+{
+    uint64_t t_us;
+    uint8_t pin;
+    uint8_t kind;
+} trace_record_t;
+
+typedef struct
+{
+    bool started;
+    uint32_t last_us; // instante (32 bits) do último evento
+    uint64_t t_us;    // o mesmo, estendido
+    uint16_t drops;   // último acumulado visto
+    uint32_t lost;    // eventos descartados na placa desde o início
+} trace_decoder_t;
+
+void trace_decoder_init(trace_decoder_t *d);
+
+// Decodifica um payload FRAME_TYPE_TRACE em até max eventos. Retorna o
+// número de eventos, ou -1 se o payload é inválido.
+int trace_unpack(trace_decoder_t *d, const uint8_t *payload, size_t len, trace_record_t *out, size_t max);
+
+#endif
@@ -0,0 +1,241 @@
+#include "frame.h"
+
+#include <string.h>
+
+// CRC-16/CCITT por nibble: tabela de 16 entradas em vez de 256
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_pos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] != 0)
+        {
+            out[o++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF)
+        {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len)
+    {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+
+        for (uint8_t k = 1; k < code; k++)
+        {
+            if (in[i] == 0)
+                return 0;
+            out[o++] = in[i++];
+        }
+        if (code < 0xFF && i < len)
+            out[o++] = 0;
+    }
+    return o;
+}
+
+size_t frame_encode(const uint8_t *payload, size_t len, uint8_t *out)
+{
+    uint8_t raw[FRAME_MAX_PAYLOAD + 2];
+    memcpy(raw, payload, len);
+
+    uint16_t crc = crc16_ccitt(payload, len);
+    raw[len] = (uint8_t)(crc >> 8);
+    raw[len + 1] = (uint8_t)crc;
+
+    out[0] = FRAME_DELIMITER;
+    size_t n = cobs_encode(raw, len + 2, out + 1);
+    out[n + 1] = FRAME_DELIMITER;
+    return n + 2;
+}
+
+size_t frame_decode(const uint8_t *in, size_t len, uint8_t *payload)
+{
+    uint8_t raw[FRAME_MAX_ENCODED];
+    if (len == 0 || len > sizeof(raw))
+        return 0;
+
+    size_t n = cobs_decode(in, len, raw);
+    if (n < 3 || n - 2 > FRAME_MAX_PAYLOAD)
+        return 0;
+
+    uint16_t crc = (uint16_t)((raw[n - 2] << 8) | raw[n - 1]);
+    if (crc16_ccitt(raw, n - 2) != crc)
+        return 0;
+
+    memcpy(payload, raw, n - 2);
+    return n - 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t frame_pack_measurement(const measurement_t *m, uint8_t *payload)
+{
+    uint8_t *p = payload;
+    *p++ = FRAME_TYPE_MEASUREMENT;
+    p = put_u32(p, m->seq);
+    p = put_u32(p, (uint32_t)m->t_descida);
+    p = put_u32(p, (uint32_t)(m->t_descida >> 32));
+    *p++ = m->sensor;
+    p = put_u32(p, m->pulse_us);
+    p = put_u32(p, m->distance_um);
+    *p++ = m->status;
+    return (size_t)(p - payload);
+}
+
+size_t frame_pack_track(const measurement_t *m, uint8_t *payload)
+{
+    size_t n = frame_pack_measurement(m, payload);
+    payload[0] = FRAME_TYPE_TRACK;
+    put_u32(payload + n, (uint32_t)m->velocity_um_s);
+    return n + 4;
+}
+
+size_t frame_pack_average(const measurement_t *m, uint8_t *payload)
+{
+    size_t n = frame_pack_track(m, payload);
+    payload[0] = FRAME_TYPE_AVERAGE;
+    uint8_t *p = put_u32(payload + n, m->min_um);
+    p = put_u32(p, m->max_um);
+    *p++ = m->shots;
+    *p++ = m->valid;
+    return (size_t)(p - payload);
+}
+
+bool frame_unpack_measurement(const uint8_t *payload, size_t len, measurement_t *m)
+{
+    bool average = len == FRAME_AVERAGE_LEN && payload[0] == FRAME_TYPE_AVERAGE;
+    bool track = average || (len == FRAME_TRACK_LEN && payload[0] == FRAME_TYPE_TRACK);
+    if (!track && (len != FRAME_MEASUREMENT_LEN || payload[0] != FRAME_TYPE_MEASUREMENT))
+        return false;
+
+    const uint8_t *p = payload + 1;
+    m->seq = get_u32(p);
+    m->t_descida = get_u32(p + 4) | ((uint64_t)get_u32(p + 8) << 32);
+    m->sensor = p[12];
+    m->pulse_us = get_u32(p + 13);
+    m->distance_um = get_u32(p + 17);
+    m->status = p[21];
+    m->velocity_um_s = track ? (int32_t)get_u32(p + 22) : 0;
+    if (average)
+    {
+        m->min_um = get_u32(p + 26);
+        m->max_um = get_u32(p + 30);
+        m->shots = p[34];
+        m->valid = p[35];
+    }
+    else
+    {
+        m->min_um = m->max_um = m->distance_um;
+        m->shots = 1;
+        m->valid = m->status == MEAS_OK;
+    }
+    return true;
+}
+
+size_t frame_pack_threshold(const threshold_event_t *e, uint8_t *payload)
+{
+    uint8_t *p = payload;
+    *p++ = FRAME_TYPE_THRESHOLD;
+    *p++ = e->sensor;
+    *p++ = e->near;
+    p = put_u32(p, (uint32_t)e->t_us);
+    p = put_u32(p, e->distance_um);
+    *p++ = (uint8_t)e->latency_us;
+    *p++ = (uint8_t)(e->latency_us >> 8);
+    return (size_t)(p - payload);
+}
+
+bool frame_unpack_threshold(const uint8_t *payload, size_t len, threshold_event_t *e)
+{
+    if (len != FRAME_THRESHOLD_LEN || payload[0] != FRAME_TYPE_THRESHOLD)
+        return false;
+
+    e->sensor = payload[1];
+    e->near = payload[2];
+    e->t_us = get_u32(payload + 3);
+    e->distance_um = get_u32(payload + 7);
+    e->latency_us = (uint16_t)(payload[11] | (payload[12] << 8));
+    return true;
+}
+
+void frame_reader_init(frame_reader_t *r)
+{
+    r->len = 0;
+    r->overflow = false;
+    r->frames = 0;
+    r->errors = 0;
+}
+
+bool frame_reader_feed(frame_reader_t *r, uint8_t byte, uint8_t *payload, size_t *len)
+{
+    if (byte != FRAME_DELIMITER)
+    {
+        if (r->len < sizeof(r->buf))
+            r->buf[r->len++] = byte;
+        else
+            r->overflow = true;
+        return false;
+    }
+
+    // Delimitadores seguidos (início e fim de quadros vizinhos) são vazios
+    if (r->len == 0 && !r->overflow)
+        return false;
+
+    size_t n = r->overflow ? 0 : frame_decode(r->buf, r->len, payload);
+    r->len = 0;
+    r->overflow = false;
+    if (n == 0)
+    {
+        r->errors++;
+        return false;
+    }
+
+    r->frames++;
+    *len = n;
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "measurement.h"
+#include "threshold.h"
+
+// Protocolo binário da saída. Cada registro é um payload de tamanho fixo
+// (primeiro byte = tipo, campos little-endian), seguido de CRC-16/CCITT
+// (poli 0x1021, início 0xFFFF, big-endian), codificado com COBS e cercado
+// por delimitadores 0x00. O delimitador inicial ressincroniza o leitor se
+// houver texto misturado no fluxo.
+
+#define FRAME_DELIMITER 0x00
+
+// Tipos de payload
+#define FRAME_TYPE_MEASUREMENT 0x01
+#define FRAME_TYPE_TRACE 0x02 // bordas do echo, ver edge_trace.h
+#define FRAME_TYPE_TRACK 0x03 // medição com velocidade do filtro de Kalman
+#define FRAME_TYPE_AVERAGE 0x04 // média de um grupo de pings ('avg')
+#define FRAME_TYPE_THRESHOLD 0x05 // transição do intertravamento
+
+// Medição: tipo, seq u32, timestamp_us u64, sensor u8, pulse_us u32,
+// distance_um u32, status u8
+#define FRAME_MEASUREMENT_LEN 23
+
+// Medição rastreada: os mesmos campos seguidos de velocity_um_s i32
+#define FRAME_TRACK_LEN 27
+
+// Média de pings: os campos da rastreada seguidos de min_um u32, max_um u32,
+// shots u8 e valid u8
+#define FRAME_AVERAGE_LEN 37
+
+// Intertravamento: tipo, sensor u8, perto u8, timestamp_us u32 (32 bits
+// baixos), distance_um u32 (0xFFFFFFFF = sem eco), latency_us u16
+#define FRAME_THRESHOLD_LEN 13
+
+// Maior payload aceito e maior quadro codificado (COBS acrescenta um byte a
+// cada 254, mais CRC e dois delimitadores)
+#define FRAME_MAX_PAYLOAD 64
+#define FRAME_MAX_ENCODED (FRAME_MAX_PAYLOAD + 2 + (FRAME_MAX_PAYLOAD + 2) / 254 + 1 + 2)
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len);
+
+// COBS. cobs_decode retorna 0 se a entrada é inválida.
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out);
+
+// Monta o quadro completo (delimitadores incluídos) de um payload
+size_t frame_encode(const uint8_t *payload, size_t len, uint8_t *out);
+
+// Desfaz COBS e confere o CRC de um quadro sem os delimitadores. Retorna o
+// tamanho do payload, ou 0 se o quadro está corrompido.
+size_t frame_decode(const uint8_t *in, size_t len, uint8_t *payload);
+
+size_t frame_pack_measurement(const measurement_t *m, uint8_t *payload);
+size_t frame_pack_track(const measurement_t *m, uint8_t *payload);
+size_t frame_pack_average(const measurement_t *m, uint8_t *payload);
+
+// Aceita os três tipos. Sem velocidade, velocity_um_s = 0; fora da média, o
+// registro conta como um ping (shots = 1, min = max = distância).
+bool frame_unpack_measurement(const uint8_t *payload, size_t len, measurement_t *m);
+
+size_t frame_pack_threshold(const threshold_event_t *e, uint8_t *payload);
+bool frame_unpack_threshold(const uint8_t *payload, size_t len, threshold_event_t *e);
+
+// Leitor de fluxo: separa os quadros pelos delimitadores
+typedef struct
+{
+    uint8_t buf[FRAME_MAX_ENCODED];
+    size_t len;
+    bool overflow;
+    uint32_t frames;
+    uint32_t errors; // quadros com COBS/CRC inválido ou grandes demais
+} frame_reader_t;
+
+void frame_reader_init(frame_reader_t *r);
+
+// Acrescenta um byte. Quando um quadro válido termina, copia o payload,
+// escreve seu tamanho em *len e retorna true.
+bool frame_reader_feed(frame_reader_t *r, uint8_t byte, uint8_t *payload, size_t *len);
+
+#endif
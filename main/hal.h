@@ -0,0 +1,98 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Camada fina entre a lógica da aplicação (acq.c, app.c, commands.c) e o
+// hardware. hal_pico.c implementa sobre o Pico SDK; host/hal_sim.c sobre um
+// relógio virtual e um modelo do HC-SR04, para rodar a aplicação no host.
+
+#define HAL_GPIO_COUNT 30
+
+// Mesmos valores de GPIO_IRQ_EDGE_FALL/RISE do SDK
+#define HAL_EDGE_FALL 0x4u
+#define HAL_EDGE_RISE 0x8u
+
+// Definição de uma função do caminho quente das IRQs (bordas do echo,
+// timeout). Com HCSR04_ISR_IN_RAM o firmware a copia para a RAM, onde não
+// espera o cache do XIP depois de um miss na flash; no host, e sem a opção,
+// é uma definição comum.
+#if HCSR04_ISR_IN_RAM
+#include "pico.h"
+#define HAL_ISR_FUNC(name) __not_in_flash_func(name)
+#else
+#define HAL_ISR_FUNC(name) name
+#endif
+
+// Mesmas assinaturas dos callbacks do SDK
+typedef void (*hal_gpio_irq_cb_t)(unsigned int pin, uint32_t events);
+typedef int64_t (*hal_alarm_cb_t)(int32_t id, void *user);
+typedef void (*hal_rx_cb_t)(void *param);
+
+// Tempo
+uint64_t hal_time_us(void);
+void hal_sleep_us(uint32_t us);
+
+// GPIO
+void hal_gpio_output(unsigned int pin);
+void hal_gpio_input(unsigned int pin);
+void hal_gpio_put(unsigned int pin, bool value);
+
+// IRQ de borda de um pino de entrada. Um único callback atende todos os
+// pinos, como no SDK.
+void hal_gpio_irq_enable(unsigned int pin, uint32_t events, hal_gpio_irq_cb_t cb);
+
+// IRQ crua: handler próprio para os pinos de pin_mask, sem o despachante
+// do SDK. O handler lê os eventos pendentes com hal_gpio_irq_events e os
+// reconhece ele mesmo com hal_gpio_irq_ack. Enquanto ativo, o callback de
+// hal_gpio_irq_enable do core fica fora da IRQ: todos os pinos com IRQ
+// devem estar em pin_mask. hal_gpio_raw_irq_disable volta ao callback.
+typedef void (*hal_irq_handler_t)(void);
+void hal_gpio_raw_irq_enable(uint32_t pin_mask, uint32_t events, hal_irq_handler_t handler);
+void hal_gpio_raw_irq_disable(uint32_t pin_mask, hal_irq_handler_t handler);
+uint32_t hal_gpio_irq_events(unsigned int pin);
+void hal_gpio_irq_ack(unsigned int pin, uint32_t events);
+
+// Nível de todos os pinos numa leitura só (bit n = pino n)
+uint32_t hal_gpio_get_all(void);
+
+// 32 bits baixos de hal_time_us(), numa leitura só do timer
+uint32_t hal_time_us32(void);
+
+// Contador de ciclos da CPU do core atual, crescente, com HAL_CYCLES_MASK
+// de largura: diferenças valem mascaradas. hal_cycles_init o liga e passa
+// a marcar a entrada de cada IRQ de GPIO do core, antes de qualquer
+// handler, lida com hal_gpio_irq_entry durante o tratamento.
+#define HAL_CYCLES_MASK 0xFFFFFFu
+void hal_cycles_init(void);
+uint32_t hal_cycles(void);
+uint32_t hal_gpio_irq_entry(void);
+
+// Alarmes de disparo único. hal_alarm_init cria o pool no contexto que
+// chama (o dos callbacks). O callback deve retornar 0. Retorna id > 0, ou
+// <= 0 se não há alarme livre.
+void hal_alarm_init(unsigned int max_alarms);
+int32_t hal_alarm_add_us(uint32_t delay_us, hal_alarm_cb_t cb, void *user);
+void hal_alarm_cancel(int32_t id);
+
+// Desliga as IRQs do core atual, para seções curtas que disputam dados
+// com elas
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t saved);
+
+// Avisa o loop principal que há trabalho, e espera por um aviso ou IRQ
+void hal_event_signal(void);
+void hal_event_wait(void);
+
+// stdio: recepção por callback e escrita sem bloqueio
+void hal_stdio_set_rx_callback(hal_rx_cb_t cb, void *param);
+int hal_stdio_getchar(void); // -1 se não há byte
+size_t hal_stdio_writable(void);
+
+// Fim de linha do stdio, para texto enviado sem tradução
+extern const char hal_stdio_eol[];
+void hal_stdio_write(const uint8_t *data, size_t len);
+
+#endif
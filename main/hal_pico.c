@@ -0,0 +1,201 @@
+#include "hal.h"
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/timer.h"
+#include "hardware/sync.h"
+
+#include "config.h"
+
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
+
+#if PICO_STDIO_DEFAULT_CRLF
+const char hal_stdio_eol[] = "\r\n";
+#else
+const char hal_stdio_eol[] = "\n";
+#endif
+
+static alarm_pool_t *alarm_pool;
+
+// Callback comum das IRQs de borda, para voltar a ele depois da IRQ crua
+static hal_gpio_irq_cb_t gpio_irq_cb;
+
+// hal_cycles() na entrada da IRQ de GPIO em curso
+static volatile uint32_t gpio_irq_entry;
+
+// Mesma leitura de time_us_64(), mas sem sair da RAM quando chamada das
+// IRQs: alta, baixa e alta de novo, até a parte alta não mudar no meio
+uint64_t HAL_ISR_FUNC(hal_time_us)(void)
+{
+    uint32_t hi = timer_hw->timerawh;
+    for (;;)
+    {
+        uint32_t lo = timer_hw->timerawl;
+        uint32_t next = timer_hw->timerawh;
+        if (next == hi)
+            return ((uint64_t)hi << 32) | lo;
+        hi = next;
+    }
+}
+
+uint32_t HAL_ISR_FUNC(hal_time_us32)(void)
+{
+    return timer_hw->timerawl;
+}
+
+void hal_sleep_us(uint32_t us)
+{
+    sleep_us(us);
+}
+
+void hal_gpio_output(unsigned int pin)
+{
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_OUT);
+    gpio_put(pin, 0);
+}
+
+void hal_gpio_input(unsigned int pin)
+{
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+}
+
+void HAL_ISR_FUNC(hal_gpio_put)(unsigned int pin, bool value)
+{
+    gpio_put(pin, value);
+}
+
+void hal_gpio_irq_enable(unsigned int pin, uint32_t events, hal_gpio_irq_cb_t cb)
+{
+    gpio_irq_cb = cb;
+    gpio_set_irq_enabled_with_callback(pin, events, true, cb);
+}
+
+void hal_gpio_raw_irq_enable(uint32_t pin_mask, uint32_t events, hal_irq_handler_t handler)
+{
+    // Sem callback o SDK tira gpio_default_irq_handler da cadeia da IRQ, e
+    // o handler cru é o único a varrer os pinos
+    gpio_set_irq_callback(NULL);
+    gpio_add_raw_irq_handler_masked(pin_mask, handler);
+    for (unsigned int pin = 0; pin < HAL_GPIO_COUNT; pin++)
+    {
+        if (pin_mask & (1u << pin))
+            gpio_set_irq_enabled(pin, events, true);
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void hal_gpio_raw_irq_disable(uint32_t pin_mask, hal_irq_handler_t handler)
+{
+    gpio_remove_raw_irq_handler_masked(pin_mask, handler);
+    if (gpio_irq_cb)
+        gpio_set_irq_callback(gpio_irq_cb);
+}
+
+uint32_t HAL_ISR_FUNC(hal_gpio_irq_events)(unsigned int pin)
+{
+    return gpio_get_irq_event_mask(pin);
+}
+
+void HAL_ISR_FUNC(hal_gpio_irq_ack)(unsigned int pin, uint32_t events)
+{
+    gpio_acknowledge_irq(pin, events);
+}
+
+uint32_t HAL_ISR_FUNC(hal_gpio_get_all)(void)
+{
+    return gpio_get_all();
+}
+
+// O M0+ não tem DWT: o SysTick, contando no clock da CPU, serve de
+// contador de ciclos. Conta para baixo; hal_cycles() inverte.
+static void HAL_ISR_FUNC(gpio_irq_probe)(void)
+{
+    gpio_irq_entry = HAL_CYCLES_MASK - systick_hw->cvr;
+}
+
+void hal_cycles_init(void)
+{
+    systick_hw->rvr = HAL_CYCLES_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // ENABLE | CLKSOURCE (CPU), sem IRQ
+    irq_add_shared_handler(IO_IRQ_BANK0, gpio_irq_probe, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+}
+
+uint32_t HAL_ISR_FUNC(hal_cycles)(void)
+{
+    return HAL_CYCLES_MASK - systick_hw->cvr;
+}
+
+uint32_t HAL_ISR_FUNC(hal_gpio_irq_entry)(void)
+{
+    return gpio_irq_entry;
+}
+
+// Pool próprio num alarme de hardware livre, separado do pool padrão que
+// atende sleep_ms() e os timers do SDK
+void hal_alarm_init(unsigned int max_alarms)
+{
+    alarm_pool = alarm_pool_create_with_unused_hardware_alarm(max_alarms);
+}
+
+int32_t hal_alarm_add_us(uint32_t delay_us, hal_alarm_cb_t cb, void *user)
+{
+    return alarm_pool_add_alarm_in_us(alarm_pool, delay_us, cb, user, false);
+}
+
+void hal_alarm_cancel(int32_t id)
+{
+    alarm_pool_cancel_alarm(alarm_pool, id);
+}
+
+uint32_t HAL_ISR_FUNC(hal_irq_save)(void)
+{
+    return save_and_disable_interrupts();
+}
+
+void HAL_ISR_FUNC(hal_irq_restore)(uint32_t saved)
+{
+    restore_interrupts(saved);
+}
+
+void HAL_ISR_FUNC(hal_event_signal)(void)
+{
+    __sev();
+}
+
+void hal_event_wait(void)
+{
+    __wfe();
+}
+
+void hal_stdio_set_rx_callback(hal_rx_cb_t cb, void *param)
+{
+    stdio_set_chars_available_callback(cb, param);
+}
+
+int hal_stdio_getchar(void)
+{
+    int ch = getchar_timeout_us(0);
+    return ch == PICO_ERROR_TIMEOUT ? -1 : ch;
+}
+
+// Quanto o stdio aceita agora sem bloquear
+size_t hal_stdio_writable(void)
+{
+#if LIB_PICO_STDIO_USB
+    return tud_cdc_connected() ? tud_cdc_write_available() : 0;
+#else
+    return OUT_DRAIN_CHUNK;
+#endif
+}
+
+void hal_stdio_write(const uint8_t *data, size_t len)
+{
+    stdio_put_string((const char *)data, (int)len, false, false);
+}
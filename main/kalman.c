@@ -0,0 +1,139 @@
+#include "kalman.h"
+
+// (a * b) >> KALMAN_FRAC_BITS sem o produto intermediário: a parte alta de
+// a é multiplicada já deslocada. Igual ao produto direto, e só estoura se
+// o resultado estourar (|b| < 2^47).
+static int64_t mul_q(int64_t a, int64_t b)
+{
+    int64_t hi = a >> KALMAN_FRAC_BITS;
+    int64_t lo = a & ((1 << KALMAN_FRAC_BITS) - 1);
+    return hi * b + ((lo * b) >> KALMAN_FRAC_BITS);
+}
+
+// a / s em Q16 (s > 0). Numerador e divisor perdem os mesmos bits baixos
+// quando a deslocada não caberia; o quociente em si sempre cabe.
+static int64_t div_q(int64_t a, int64_t s)
+{
+    while (a > INT64_MAX >> (KALMAN_FRAC_BITS + 1) || a < -(INT64_MAX >> (KALMAN_FRAC_BITS + 1)))
+    {
+        a /= 2;
+        s /= 2;
+    }
+    return (a << KALMAN_FRAC_BITS) / s;
+}
+
+void kalman_init(kalman_t *k, uint32_t noise_um, uint32_t accel_um_s2)
+{
+    if (noise_um > KALMAN_NOISE_MAX_UM)
+        noise_um = KALMAN_NOISE_MAX_UM;
+    if (accel_um_s2 > KALMAN_ACCEL_MAX_UM_S2)
+        accel_um_s2 = KALMAN_ACCEL_MAX_UM_S2;
+    k->enabled = noise_um > 0;
+    k->started = false;
+    k->noise_um = noise_um;
+    k->accel_um_s2 = accel_um_s2;
+    k->q = (uint64_t)accel_um_s2 * accel_um_s2;
+    k->updates = 0;
+    k->missed = 0;
+}
+
+void kalman_predict(kalman_t *k, uint64_t t_us)
+{
+    if (!k->started || t_us <= k->t_us)
+        return;
+
+    uint64_t dt_us = t_us - k->t_us;
+    k->t_us = t_us;
+    if (t_us - k->t_obs > KALMAN_RESET_US)
+    {
+        k->started = false;
+        return;
+    }
+
+    // dt em segundos, Q16
+    int64_t dt = (int64_t)((dt_us << KALMAN_FRAC_BITS) / 1000000);
+
+    k->d += mul_q(k->v, dt);
+
+    // P = F P F' + Q, com F = [1 dt; 0 1] e Q de aceleração branca:
+    // [dt^3/3 dt^2/2; dt^2/2 dt] * q
+    int64_t p11_dt = mul_q(k->p11, dt);
+    int64_t q_dt = mul_q((int64_t)k->q, dt);
+    int64_t q_dt2 = mul_q(q_dt, dt);
+    int64_t q_dt3 = mul_q(q_dt2, dt);
+
+    k->p00 += mul_q(2 * k->p01 + p11_dt, dt) + q_dt3 / 3;
+    k->p01 += p11_dt + q_dt2 / 2;
+    k->p11 += q_dt;
+}
+
+void kalman_update(kalman_t *k, uint64_t t_us, int32_t z_um)
+{
+    if (!k->started)
+    {
+        k->started = true;
+        k->t_us = t_us;
+        k->t_obs = t_us;
+        k->d = z_um;
+        k->v = 0;
+        k->p00 = (int64_t)k->noise_um * k->noise_um;
+        k->p01 = 0;
+        k->p11 = (int64_t)KALMAN_V0_SIGMA_UM_S * KALMAN_V0_SIGMA_UM_S;
+        k->updates++;
+        return;
+    }
+
+    kalman_predict(k, t_us);
+    if (!k->started)
+    {
+        // Intervalo longo demais: recomeça desta medição
+        kalman_update(k, t_us, z_um);
+        return;
+    }
+
+    // Ganho K = P H' / (H P H' + R), H = [1 0], em Q16
+    int64_t r = (int64_t)k->noise_um * k->noise_um;
+    int64_t s = k->p00 + r;
+    int64_t k1 = div_q(k->p01, s);
+    int64_t y = z_um - k->d;
+    int64_t p01 = k->p01;
+
+    // P = (I - K H) P. Com p00 > r, k0 fica perto de 1 e x (1 - k0) perde
+    // os bits baixos: usa 1 - k0 = r / s, que aí é pequeno e exato.
+    if (k->p00 > r)
+    {
+        int64_t kr = div_q(r, s);
+        k->d = z_um - mul_q(y, kr);
+        k->p00 = r - mul_q(r, kr);
+        k->p01 = mul_q(r, k1);
+    }
+    else
+    {
+        int64_t k0 = div_q(k->p00, s);
+        k->d += mul_q(y, k0);
+        k->p00 -= mul_q(k->p00, k0);
+        k->p01 -= mul_q(p01, k0);
+    }
+    // k1 * p01 = p01^2 / s, que não passa de p11
+    k->v += mul_q(y, k1);
+    k->p11 = k->p11 - mul_q(p01, k1);
+    k->t_obs = t_us;
+    k->updates++;
+}
+
+void kalman_apply(kalman_t *k, measurement_t *m)
+{
+    if (!k->enabled)
+        return;
+
+    if (m->status != MEAS_OK)
+    {
+        kalman_predict(k, m->t_descida);
+        k->missed++;
+        return;
+    }
+
+    kalman_update(k, m->t_descida, (int32_t)m->distance_um);
+    m->distance_um = k->d < 0 ? 0 : (uint32_t)k->d;
+    m->velocity_um_s = (int32_t)k->v;
+}
@@ -0,0 +1,81 @@
+#ifndef KALMAN_H
+#define KALMAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "measurement.h"
+
+// Filtro de Kalman 1-D de velocidade constante, em ponto fixo (inteiros de
+// 64 bits; o M0+ não tem FPU). Estado: distância em um e velocidade em
+// um/s (positiva afastando). Cada medição válida é uma observação; falhas
+// e outliers só propagam o estado (observação perdida).
+//
+// Ruído de medição: desvio padrão da distância medida. Ruído de processo:
+// aceleração aleatória (densidade espectral sigma_a^2), que define quão
+// rápido o filtro acompanha mudanças de velocidade.
+
+// Frações binárias do tempo (segundos) e dos ganhos
+#define KALMAN_FRAC_BITS 16
+
+// Maior intervalo sem observação; acima disso o filtro recomeça da próxima
+// medição. Limita quanto P cresce numa sequência de medições perdidas.
+#ifndef KALMAN_RESET_US
+#define KALMAN_RESET_US 2000000
+#endif
+
+// Desvio padrão inicial da velocidade, em um/s
+#ifndef KALMAN_V0_SIGMA_UM_S
+#define KALMAN_V0_SIGMA_UM_S 1000000
+#endif
+
+#define KALMAN_NOISE_UM_DEFAULT 3000     // 3 mm
+#define KALMAN_ACCEL_UM_S2_DEFAULT 500000 // 0,5 m/s^2
+
+// Faixa aceita por kalman_init (valores acima são limitados). Com
+// KALMAN_RESET_US = 2 s, P chega a ~1e17 um^2 no pior caso, abaixo dos
+// 9,2e18 do int64; os produtos por dt e pelos ganhos não passam do próprio
+// resultado. 'hcsr04_bench kalman' confere o limite contra um filtro em
+// double.
+#define KALMAN_NOISE_MAX_UM 1000000       // 1 m
+#define KALMAN_ACCEL_MAX_UM_S2 100000000  // 100 m/s^2
+
+typedef struct
+{
+    bool enabled;
+    bool started;
+    uint64_t q; // sigma_a^2, em um^2/s^4
+    uint32_t noise_um;
+    uint32_t accel_um_s2;
+
+    uint64_t t_us;  // instante do estado
+    uint64_t t_obs; // instante da última observação
+    int64_t d;      // um
+    int64_t v;      // um/s
+    int64_t p00;    // um^2
+    int64_t p01;    // um^2/s
+    int64_t p11;    // um^2/s^2
+
+    uint32_t updates;
+    uint32_t missed;
+} kalman_t;
+
+// noise_um = 0 desliga o filtro
+void kalman_init(kalman_t *k, uint32_t noise_um, uint32_t accel_um_s2);
+
+static inline bool kalman_enabled(const kalman_t *k)
+{
+    return k->enabled;
+}
+
+// Propaga o estado até t_us, sem observação
+void kalman_predict(kalman_t *k, uint64_t t_us);
+
+// Observa uma distância em t_us
+void kalman_update(kalman_t *k, uint64_t t_us, int32_t z_um);
+
+// Aplica o filtro a uma medição: se válida, sai com a distância suavizada
+// e a velocidade; senão conta como observação perdida
+void kalman_apply(kalman_t *k, measurement_t *m);
+
+#endif
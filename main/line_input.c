@@ -0,0 +1,79 @@
+#include "line_input.h"
+
+void line_rx_init(line_rx_t *rx)
+{
+    atomic_store_explicit(&rx->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&rx->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&rx->overruns, 0, memory_order_relaxed);
+}
+
+bool line_rx_push(line_rx_t *rx, uint8_t c, uint32_t t_us)
+{
+    uint32_t head = atomic_load_explicit(&rx->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&rx->tail, memory_order_acquire);
+
+    if (head - tail >= LINE_RX_SIZE)
+    {
+        atomic_store_explicit(&rx->overruns, atomic_load_explicit(&rx->overruns, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    rx->ch[head & (LINE_RX_SIZE - 1)] = c;
+    rx->t_us[head & (LINE_RX_SIZE - 1)] = t_us;
+    atomic_store_explicit(&rx->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool line_rx_pop(line_rx_t *rx, uint8_t *c, uint32_t *t_us)
+{
+    uint32_t tail = atomic_load_explicit(&rx->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&rx->head, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    *c = rx->ch[tail & (LINE_RX_SIZE - 1)];
+    *t_us = rx->t_us[tail & (LINE_RX_SIZE - 1)];
+    atomic_store_explicit(&rx->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+void line_asm_init(line_asm_t *a)
+{
+    a->len = 0;
+    a->ready = false;
+    a->t_end_us = 0;
+}
+
+bool line_asm_feed(line_asm_t *a, uint8_t c, uint32_t t_us)
+{
+    // A linha entregue na chamada anterior já foi consumida
+    if (a->ready)
+    {
+        a->len = 0;
+        a->ready = false;
+    }
+
+    if (c == '\n' || c == '\r')
+    {
+        if (a->len == 0)
+            return false;
+        a->buf[a->len] = '\0';
+        a->t_end_us = t_us;
+        a->ready = true;
+        return true;
+    }
+
+    if (a->len < LINE_MAX_LEN)
+        a->buf[a->len++] = (char)c;
+    return false;
+}
+
+void line_latency_add(line_latency_t *l, uint32_t us)
+{
+    l->count++;
+    l->sum_us += us;
+    if (us > l->max_us)
+        l->max_us = us;
+}
@@ -0,0 +1,65 @@
+#ifndef LINE_INPUT_H
+#define LINE_INPUT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Entrada de comandos orientada a eventos: a IRQ de "caracteres
+// disponíveis" do stdio empurra bytes (com o instante de chegada) num anel,
+// e o loop principal monta as linhas quando acorda.
+
+// Capacidade do anel de recepção (potência de 2)
+#ifndef LINE_RX_SIZE
+#define LINE_RX_SIZE 64
+#endif
+
+// Maior linha aceita, sem o '\0'. O excedente é descartado.
+#ifndef LINE_MAX_LEN
+#define LINE_MAX_LEN 63
+#endif
+
+#if (LINE_RX_SIZE & (LINE_RX_SIZE - 1)) != 0
+#error "LINE_RX_SIZE deve ser potência de 2"
+#endif
+
+// Anel de um produtor (IRQ) e um consumidor (loop principal)
+typedef struct
+{
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t overruns; // bytes perdidos com o anel cheio
+    uint8_t ch[LINE_RX_SIZE];
+    uint32_t t_us[LINE_RX_SIZE];
+} line_rx_t;
+
+// Montador de linhas
+typedef struct
+{
+    char buf[LINE_MAX_LEN + 1];
+    uint8_t len;
+    bool ready;
+    uint32_t t_end_us; // chegada do terminador da última linha
+} line_asm_t;
+
+// Latência entre a chegada do terminador e a execução do comando
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+} line_latency_t;
+
+void line_rx_init(line_rx_t *rx);
+bool line_rx_push(line_rx_t *rx, uint8_t c, uint32_t t_us);
+bool line_rx_pop(line_rx_t *rx, uint8_t *c, uint32_t *t_us);
+
+void line_asm_init(line_asm_t *a);
+
+// Acrescenta um byte. Retorna true quando uma linha não vazia terminou; ela
+// fica em a->buf até a próxima chamada.
+bool line_asm_feed(line_asm_t *a, uint8_t c, uint32_t t_us);
+
+void line_latency_add(line_latency_t *l, uint32_t us);
+
+#endif
@@ -0,0 +1,52 @@
+#include "meas_ring.h"
+
+void meas_ring_init(meas_ring_t *r)
+{
+    atomic_store_explicit(&r->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->high_water, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->drops, 0, memory_order_relaxed);
+}
+
+bool meas_ring_push(meas_ring_t *r, const measurement_t *m)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t used = head - tail;
+
+    if (used >= MEAS_RING_SIZE)
+    {
+        atomic_store_explicit(&r->drops, atomic_load_explicit(&r->drops, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    r->buf[head & (MEAS_RING_SIZE - 1)] = *m;
+    // Publica o registro antes do novo head
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+
+    if (used + 1 > atomic_load_explicit(&r->high_water, memory_order_relaxed))
+        atomic_store_explicit(&r->high_water, used + 1, memory_order_relaxed);
+    return true;
+}
+
+bool meas_ring_pop(meas_ring_t *r, measurement_t *m)
+{
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    *m = r->buf[tail & (MEAS_RING_SIZE - 1)];
+    // Libera a posição só depois de copiar o registro
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t meas_ring_count(meas_ring_t *r)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return head - tail;
+}
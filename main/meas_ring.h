@@ -0,0 +1,41 @@
+#ifndef MEAS_RING_H
+#define MEAS_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "measurement.h"
+
+// Capacidade do anel (potência de 2)
+#ifndef MEAS_RING_SIZE
+#define MEAS_RING_SIZE 64
+#endif
+
+#if (MEAS_RING_SIZE & (MEAS_RING_SIZE - 1)) != 0
+#error "MEAS_RING_SIZE deve ser potência de 2"
+#endif
+
+// Fila sem trava de um produtor e um consumidor. head só é escrito pelo
+// produtor e tail só pelo consumidor; os índices crescem livremente e são
+// mascarados no acesso.
+typedef struct
+{
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t high_water; // maior ocupação observada pelo produtor
+    _Atomic uint32_t drops;      // registros descartados com o anel cheio
+    measurement_t buf[MEAS_RING_SIZE];
+} meas_ring_t;
+
+void meas_ring_init(meas_ring_t *r);
+
+// Produtor. Retorna false (e conta um descarte) se o anel está cheio.
+bool meas_ring_push(meas_ring_t *r, const measurement_t *m);
+
+// Consumidor. Retorna false se o anel está vazio.
+bool meas_ring_pop(meas_ring_t *r, measurement_t *m);
+
+uint32_t meas_ring_count(meas_ring_t *r);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    MEAS_OK = 0,
+    MEAS_TIMEOUT,
+    MEAS_OUTLIER, // rejeitada pelo filtro de mediana; distância = mediana
+} meas_status_t;
+
+// Registro de tamanho fixo de uma medição, entregue pela aquisição (core1)
+// para a saída (core0)
+typedef struct
+{
+    uint64_t t_descida; // us desde o boot da descida do echo (falha: do disparo)
+    uint32_t seq;       // id do disparo, global entre sensores (com 'avg', o do primeiro ping)
+    uint32_t pulse_us;
+    uint32_t distance_um;
+    int32_t velocity_um_s; // filtro de Kalman; 0 se desligado
+    uint32_t min_um; // extremos dos pings válidos agregados
+    uint32_t max_um;
+    uint8_t sensor;
+    uint8_t status; // meas_status_t
+    uint8_t shots;  // pings agregados no registro, >1 com oversampling ('avg')
+    uint8_t valid;  // pings válidos entre eles; distância e pulso são a média
+} measurement_t;
+
+#endif
@@ -0,0 +1,234 @@
+#include "median_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Índices do heap vão de -(n/2) a (n-1)/2: positivos no heap de mínimo,
+// negativos no de máximo, 0 é a mediana
+#define HEAP(m, i) ((m)->heap[(i) + (m)->n / 2])
+#define MIN_CT(m) (((m)->ct - 1) / 2)
+#define MAX_CT(m) ((m)->ct / 2)
+
+static bool heap_less(const mediator_t *m, int i, int j)
+{
+    return m->data[HEAP(m, i)] < m->data[HEAP(m, j)];
+}
+
+static void heap_swap(mediator_t *m, int i, int j)
+{
+    uint8_t t = HEAP(m, i);
+    HEAP(m, i) = HEAP(m, j);
+    HEAP(m, j) = t;
+    m->pos[HEAP(m, i)] = (int8_t)i;
+    m->pos[HEAP(m, j)] = (int8_t)j;
+}
+
+// Troca se heap[i] < heap[j]
+static bool heap_cmp_swap(mediator_t *m, int i, int j)
+{
+    if (!heap_less(m, i, j))
+        return false;
+    heap_swap(m, i, j);
+    return true;
+}
+
+// Descem a partir do filho i, até que ele e os abaixo respeitem o heap. Com
+// i = 1 ou -1 o primeiro pai é a própria mediana.
+static void min_sort_down(mediator_t *m, int i)
+{
+    for (; i <= MIN_CT(m); i *= 2)
+    {
+        if (i > 1 && i < MIN_CT(m) && heap_less(m, i + 1, i))
+            i++;
+        if (!heap_cmp_swap(m, i, i / 2))
+            break;
+    }
+}
+
+static void max_sort_down(mediator_t *m, int i)
+{
+    for (; i >= -MAX_CT(m); i *= 2)
+    {
+        if (i < -1 && i > -MAX_CT(m) && heap_less(m, i, i - 1))
+            i--;
+        if (!heap_cmp_swap(m, i / 2, i))
+            break;
+    }
+}
+
+// Sobem até a raiz comum; retornam true se o valor virou a mediana
+static bool min_sort_up(mediator_t *m, int i)
+{
+    while (i > 0 && heap_cmp_swap(m, i, i / 2))
+        i /= 2;
+    return i == 0;
+}
+
+static bool max_sort_up(mediator_t *m, int i)
+{
+    while (i < 0 && heap_cmp_swap(m, i / 2, i))
+        i /= 2;
+    return i == 0;
+}
+
+void mediator_init(mediator_t *m, uint8_t n)
+{
+    if (n > MEDIAN_MAX_WINDOW)
+        n = MEDIAN_MAX_WINDOW;
+    m->n = n;
+    m->idx = 0;
+    m->ct = 0;
+
+    // Os valores entram alternando entre mediana, heap de máximo e de mínimo
+    for (int k = 0; k < n; k++)
+    {
+        int p = ((k + 1) / 2) * ((k & 1) ? -1 : 1);
+        m->pos[k] = (int8_t)p;
+        HEAP(m, p) = (uint8_t)k;
+        m->data[k] = 0;
+    }
+}
+
+// Primeiro posto de a[0..n) com valor >= v
+static int lower_bound(const int32_t *a, int n, int32_t v)
+{
+    int lo = 0, hi = n;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (a[mid] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Troca old por v na cópia ordenada (ou só insere v, se is_new)
+static void sorted_replace(mediator_t *m, bool is_new, int32_t old, int32_t v)
+{
+    int ct = m->ct;
+    int r = is_new ? ct : lower_bound(m->sorted, ct, old);
+    int q = lower_bound(m->sorted, ct, v);
+    if (q > r)
+    {
+        // Os valores entre os dois postos descem uma posição
+        memmove(&m->sorted[r], &m->sorted[r + 1], (size_t)(q - 1 - r) * sizeof(int32_t));
+        q--;
+    }
+    else
+    {
+        memmove(&m->sorted[q + 1], &m->sorted[q], (size_t)(r - q) * sizeof(int32_t));
+    }
+    m->sorted[q] = v;
+}
+
+void mediator_insert(mediator_t *m, int32_t v)
+{
+    bool is_new = m->ct < m->n;
+    int p = m->pos[m->idx];
+    int32_t old = m->data[m->idx];
+    sorted_replace(m, is_new, old, v);
+    m->data[m->idx] = v;
+    m->idx = (uint8_t)((m->idx + 1) % m->n);
+    if (is_new)
+        m->ct++;
+
+    if (p > 0)
+    {
+        if (!is_new && old < v)
+            min_sort_down(m, p * 2);
+        else if (min_sort_up(m, p))
+            max_sort_down(m, -1);
+    }
+    else if (p < 0)
+    {
+        if (!is_new && v < old)
+            max_sort_down(m, p * 2);
+        else if (max_sort_up(m, p))
+            min_sort_down(m, 1);
+    }
+    else
+    {
+        if (MAX_CT(m))
+            max_sort_down(m, -1);
+        if (MIN_CT(m))
+            min_sort_down(m, 1);
+    }
+}
+
+int32_t mediator_median(const mediator_t *m)
+{
+    int32_t v = m->data[HEAP(m, 0)];
+    if ((m->ct & 1) == 0)
+        v = (int32_t)(((int64_t)v + m->data[HEAP(m, -1)]) / 2);
+    return v;
+}
+
+// k-ésimo menor desvio (base 0) em relação a median. Com s = primeiro
+// posto >= median, os desvios abaixo, L(i) = median - sorted[s - 1 - i], e
+// acima, R(j) = sorted[s + j] - median, crescem com i e j: a busca acha
+// quantos dos k + 1 menores vêm de L.
+static int32_t mad_kth(const mediator_t *m, int s, int32_t median, int k)
+{
+    const int32_t *a = m->sorted;
+    int left = s, right = m->ct - s;
+    int t = k + 1;
+    int lo = t > right ? t - right : 0;
+    int hi = t < left ? t : left;
+    while (lo < hi)
+    {
+        int i = (lo + hi) / 2;
+        // L(i) menor que o maior de R que entraria: cabe mais um de L
+        if (median - a[s - 1 - i] < a[s + t - i - 1] - median)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+
+    int32_t v = 0;
+    if (lo > 0)
+        v = median - a[s - lo];
+    if (t - lo > 0 && a[s + t - lo - 1] - median > v)
+        v = a[s + t - lo - 1] - median;
+    return v;
+}
+
+int32_t mediator_mad(const mediator_t *m, int32_t median)
+{
+    int s = lower_bound(m->sorted, m->ct, median);
+    int32_t v = mad_kth(m, s, median, m->ct / 2);
+    if ((m->ct & 1) == 0)
+        v = (int32_t)(((int64_t)v + mad_kth(m, s, median, m->ct / 2 - 1)) / 2);
+    return v;
+}
+
+void median_filter_init(median_filter_t *f, uint8_t window, uint16_t k_deci)
+{
+    mediator_init(&f->win, window);
+    f->k_deci = k_deci;
+    f->samples = 0;
+    f->outliers = 0;
+}
+
+void median_filter_apply(median_filter_t *f, measurement_t *m)
+{
+    if (!median_filter_enabled(f) || m->status != MEAS_OK)
+        return;
+
+    int32_t x = (int32_t)m->distance_um;
+    mediator_insert(&f->win, x);
+    int32_t median = mediator_median(&f->win);
+    int32_t mad = mediator_mad(&f->win, median);
+    if (mad < MEDIAN_MAD_MIN_UM)
+        mad = MEDIAN_MAD_MIN_UM;
+
+    // |x - mediana| > k * 1,4826 * MAD, com k em décimos
+    f->samples++;
+    if ((int64_t)abs(x - median) * 100000 > (int64_t)f->k_deci * 14826 * mad)
+    {
+        m->status = MEAS_OUTLIER;
+        f->outliers++;
+    }
+    m->distance_um = (uint32_t)median;
+}
@@ -0,0 +1,80 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "measurement.h"
+
+// Mediana móvel com rejeição de outliers por MAD (filtro de Hampel).
+//
+// A janela é mantida num "mediator": dois heaps (máximo abaixo da mediana,
+// mínimo acima) dentro de um único vetor de índices, com a mediana no
+// centro, e uma fila circular dos valores com a posição de cada um no heap.
+// Trocar o valor mais antigo pelo novo custa O(log n).
+//
+// Para o MAD (mediana dos desvios absolutos) o mediator guarda também a
+// janela em ordem crescente. Os desvios abaixo e acima da mediana formam
+// duas sequências já ordenadas, e o k-ésimo desvio sai de uma busca binária
+// entre elas, em O(log n), sem copiar nem selecionar a janela a cada
+// amostra. A cópia ordenada é atualizada achando por busca binária o posto
+// do valor que sai e o do que entra, e deslocando só os valores entre os
+// dois: poucos numa série estável, até n num salto de um extremo a outro
+// da janela (no máximo MEDIAN_MAX_WINDOW palavras, um memmove curto).
+
+#define MEDIAN_MAX_WINDOW 31
+
+// Abaixo disso o MAD é considerado desse valor, para que a quantização de
+// uma janela quase constante não marque tudo como outlier
+#ifndef MEDIAN_MAD_MIN_UM
+#define MEDIAN_MAD_MIN_UM 1000
+#endif
+
+// Limite padrão, em décimos de MAD normalizado (1,4826 * MAD ≈ desvio
+// padrão para ruído gaussiano)
+#define MEDIAN_K_DECI_DEFAULT 30
+
+typedef struct
+{
+    int32_t data[MEDIAN_MAX_WINDOW]; // fila circular dos valores
+    int8_t pos[MEDIAN_MAX_WINDOW];   // posição de cada valor no heap
+    uint8_t heap[MEDIAN_MAX_WINDOW]; // heap[i + n / 2] = índice em data
+    int32_t sorted[MEDIAN_MAX_WINDOW]; // os ct valores em ordem crescente
+    uint8_t n;
+    uint8_t idx; // próxima posição da fila
+    uint8_t ct;  // valores na janela
+} mediator_t;
+
+void mediator_init(mediator_t *m, uint8_t n);
+
+// Acrescenta um valor, tirando o mais antigo se a janela está cheia
+void mediator_insert(mediator_t *m, int32_t v);
+
+// Mediana da janela (com número par de valores, a média dos dois centrais)
+int32_t mediator_median(const mediator_t *m);
+
+// Mediana dos desvios absolutos em relação a median
+int32_t mediator_mad(const mediator_t *m, int32_t median);
+
+typedef struct
+{
+    mediator_t win;
+    uint16_t k_deci; // limite de rejeição em décimos de MAD normalizado
+    uint32_t samples;
+    uint32_t outliers;
+} median_filter_t;
+
+// window 0 ou 1 desliga o filtro
+void median_filter_init(median_filter_t *f, uint8_t window, uint16_t k_deci);
+
+static inline bool median_filter_enabled(const median_filter_t *f)
+{
+    return f->win.n > 1;
+}
+
+// Aplica o filtro a uma medição: uma medição válida entra na janela e sai
+// com a mediana como distância, e com MEAS_OUTLIER se ela se afastou da
+// mediana mais que o limite. Falhas passam sem mudança.
+void median_filter_apply(median_filter_t *f, measurement_t *m);
+
+#endif
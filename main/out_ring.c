@@ -0,0 +1,115 @@
+#include "out_ring.h"
+
+#include <string.h>
+
+void out_ring_init(out_ring_t *r, out_policy_t policy)
+{
+    atomic_store_explicit(&r->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->rec_head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->rec_tail, 0, memory_order_relaxed);
+    r->policy = policy;
+    memset(&r->stats, 0, sizeof(r->stats));
+}
+
+// Descarta o registro mais antigo (só com produtor e dreno no mesmo contexto)
+static void drop_oldest(out_ring_t *r)
+{
+    uint32_t rec_tail = atomic_load_explicit(&r->rec_tail, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t end = r->rec[rec_tail & (OUT_RING_RECORDS - 1)].end;
+
+    r->stats.bytes_dropped += end - tail;
+    r->stats.records_dropped++;
+    atomic_store_explicit(&r->tail, end, memory_order_relaxed);
+    atomic_store_explicit(&r->rec_tail, rec_tail + 1, memory_order_relaxed);
+}
+
+bool out_ring_write(out_ring_t *r, const void *data, size_t len, uint32_t now_us)
+{
+    if (len == 0)
+        return true;
+    if (len > OUT_RING_SIZE)
+    {
+        r->stats.bytes_dropped += (uint32_t)len;
+        r->stats.records_dropped++;
+        return false;
+    }
+
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t rec_head = atomic_load_explicit(&r->rec_head, memory_order_relaxed);
+
+    while (head - atomic_load_explicit(&r->tail, memory_order_acquire) + len > OUT_RING_SIZE ||
+           rec_head - atomic_load_explicit(&r->rec_tail, memory_order_acquire) >= OUT_RING_RECORDS)
+    {
+        if (r->policy == OUT_DROP_NEWEST)
+        {
+            r->stats.bytes_dropped += (uint32_t)len;
+            r->stats.records_dropped++;
+            return false;
+        }
+        drop_oldest(r);
+    }
+
+    // Cópia em até dois pedaços, se o registro passa do fim do buffer
+    uint32_t pos = head & (OUT_RING_SIZE - 1);
+    size_t first = OUT_RING_SIZE - pos;
+    if (first > len)
+        first = len;
+    memcpy(&r->buf[pos], data, first);
+    memcpy(&r->buf[0], (const uint8_t *)data + first, len - first);
+
+    r->rec[rec_head & (OUT_RING_RECORDS - 1)] = (out_record_t){head + (uint32_t)len, now_us};
+    atomic_store_explicit(&r->head, head + (uint32_t)len, memory_order_release);
+    atomic_store_explicit(&r->rec_head, rec_head + 1, memory_order_release);
+
+    r->stats.bytes_queued += (uint32_t)len;
+    uint32_t used = out_ring_used(r);
+    if (used > r->stats.high_water)
+        r->stats.high_water = used;
+    return true;
+}
+
+size_t out_ring_drain(out_ring_t *r, size_t limit, out_writer_t writer, void *ctx, uint32_t now_us)
+{
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t rec_tail = atomic_load_explicit(&r->rec_tail, memory_order_relaxed);
+    uint32_t rec_head = atomic_load_explicit(&r->rec_head, memory_order_acquire);
+
+    // Registros inteiros que cabem no limite
+    uint32_t end = tail;
+    while (rec_tail != rec_head)
+    {
+        const out_record_t *rec = &r->rec[rec_tail & (OUT_RING_RECORDS - 1)];
+        if (rec->end - tail > limit)
+            break;
+
+        end = rec->end;
+        uint32_t latency = now_us - rec->t_us;
+        if (latency > r->stats.max_latency_us)
+            r->stats.max_latency_us = latency;
+        rec_tail++;
+    }
+
+    size_t len = end - tail;
+    if (len == 0)
+        return 0;
+
+    uint32_t pos = tail & (OUT_RING_SIZE - 1);
+    size_t first = OUT_RING_SIZE - pos;
+    if (first > len)
+        first = len;
+    writer(&r->buf[pos], first, ctx);
+    if (len > first)
+        writer(&r->buf[0], len - first, ctx);
+
+    r->stats.bytes_flushed += (uint32_t)len;
+    atomic_store_explicit(&r->rec_tail, rec_tail, memory_order_release);
+    atomic_store_explicit(&r->tail, end, memory_order_release);
+    return len;
+}
+
+uint32_t out_ring_used(out_ring_t *r)
+{
+    return atomic_load_explicit(&r->head, memory_order_acquire) - atomic_load_explicit(&r->tail, memory_order_acquire);
+}
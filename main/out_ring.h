@@ -0,0 +1,79 @@
+#ifndef OUT_RING_H
+#define OUT_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fila de saída em bytes. Cada registro (uma linha de texto ou um quadro
+// binário) entra inteiro ou é descartado, e o dreno envia vários registros
+// inteiros de uma vez, só até o quanto o stdio aceita sem bloquear. Assim um
+// host que parou de ler não trava a geração das medições.
+//
+// Com OUT_DROP_NEWEST a fila é SPSC sem trava. OUT_DROP_OLDEST descarta
+// registros a partir do produtor, então produtor e dreno devem rodar no
+// mesmo contexto (como no loop principal do core0).
+
+// Capacidade em bytes e em registros (potências de 2)
+#ifndef OUT_RING_SIZE
+#define OUT_RING_SIZE 4096
+#endif
+
+#ifndef OUT_RING_RECORDS
+#define OUT_RING_RECORDS 256
+#endif
+
+#if (OUT_RING_SIZE & (OUT_RING_SIZE - 1)) != 0 || (OUT_RING_RECORDS & (OUT_RING_RECORDS - 1)) != 0
+#error "OUT_RING_SIZE e OUT_RING_RECORDS devem ser potências de 2"
+#endif
+
+typedef enum
+{
+    OUT_DROP_NEWEST = 0, // fila cheia: o registro novo é descartado
+    OUT_DROP_OLDEST,     // fila cheia: os registros mais antigos dão lugar
+} out_policy_t;
+
+typedef struct
+{
+    uint32_t end;  // posição (absoluta) do fim do registro
+    uint32_t t_us; // instante da entrada na fila
+} out_record_t;
+
+typedef struct
+{
+    uint32_t bytes_queued;
+    uint32_t bytes_flushed;
+    uint32_t bytes_dropped;
+    uint32_t records_dropped;
+    uint32_t max_latency_us; // maior espera entre entrada na fila e envio
+    uint32_t high_water;     // maior ocupação em bytes
+} out_stats_t;
+
+typedef struct
+{
+    _Atomic uint32_t head; // bytes
+    _Atomic uint32_t tail;
+    _Atomic uint32_t rec_head;
+    _Atomic uint32_t rec_tail;
+    out_policy_t policy;
+    out_stats_t stats;
+    uint8_t buf[OUT_RING_SIZE];
+    out_record_t rec[OUT_RING_RECORDS];
+} out_ring_t;
+
+// Envia bytes já garantidamente aceitos pelo destino
+typedef void (*out_writer_t)(const uint8_t *data, size_t len, void *ctx);
+
+void out_ring_init(out_ring_t *r, out_policy_t policy);
+
+// Enfileira um registro inteiro. Retorna false se ele foi descartado.
+bool out_ring_write(out_ring_t *r, const void *data, size_t len, uint32_t now_us);
+
+// Envia registros inteiros somando no máximo limit bytes. Retorna os bytes
+// enviados.
+size_t out_ring_drain(out_ring_t *r, size_t limit, out_writer_t writer, void *ctx, uint32_t now_us);
+
+uint32_t out_ring_used(out_ring_t *r);
+
+#endif
@@ -0,0 +1,103 @@
+#include "scheduler.h"
+
+void sched_init(scheduler_t *s, uint8_t count, uint32_t interval_us, uint32_t guard_us)
+{
+    s->count = count;
+    s->next = 0;
+    s->active = -1;
+    s->interval_us = interval_us;
+    s->guard_us = guard_us;
+    s->ready_at = 0;
+    s->busy = 0;
+    s->shots = 1;
+    s->group = -1;
+    s->group_left = 0;
+    for (uint8_t i = 0; i < SENSOR_MAX; i++)
+        s->due[i] = 0;
+    sched_reset_stats(s, 0);
+}
+
+void sched_set_timing(scheduler_t *s, uint32_t interval_us, uint32_t guard_us)
+{
+    // Prazos calculados com o intervalo antigo não valem mais
+    for (uint8_t i = 0; i < SENSOR_MAX; i++)
+        s->due[i] = 0;
+    s->interval_us = interval_us;
+    s->guard_us = guard_us;
+    s->group = -1;
+}
+
+void sched_set_shots(scheduler_t *s, uint8_t shots)
+{
+    s->shots = shots > 0 ? shots : 1;
+    s->group = -1;
+}
+
+int sched_next(scheduler_t *s, uint64_t now_us)
+{
+    if (s->active >= 0 || now_us < s->ready_at)
+        return -1;
+
+    // Pings restantes do grupo corrente: só esperam a guarda
+    if (s->group >= 0)
+    {
+        uint8_t i = (uint8_t)s->group;
+        if (s->busy & (1u << i))
+            return -1;
+        if (--s->group_left == 0)
+            s->group = -1;
+        s->active = (int8_t)i;
+        return i;
+    }
+
+    // Round-robin a partir do sucessor do último disparado
+    for (uint8_t k = 0; k < s->count; k++)
+    {
+        uint8_t i = (uint8_t)((s->next + k) % s->count);
+        if (now_us >= s->due[i] && !(s->busy & (1u << i)))
+        {
+            s->active = (int8_t)i;
+            s->due[i] = now_us + s->interval_us;
+            s->next = (uint8_t)((i + 1) % s->count);
+            if (s->shots > 1)
+            {
+                s->group = (int8_t)i;
+                s->group_left = (uint8_t)(s->shots - 1);
+            }
+            return i;
+        }
+    }
+    return -1;
+}
+
+void sched_done(scheduler_t *s, uint8_t idx, bool ok, uint64_t now_us)
+{
+    if (s->active == (int8_t)idx)
+    {
+        s->active = -1;
+        s->ready_at = now_us + s->guard_us;
+    }
+
+    if (ok)
+        s->ok[idx]++;
+    else
+        s->failed[idx]++;
+}
+
+uint32_t sched_rate_mhz(const scheduler_t *s, uint8_t idx, uint64_t now_us)
+{
+    uint64_t elapsed = now_us - s->stats_start;
+    if (elapsed == 0)
+        return 0;
+    return (uint32_t)((uint64_t)s->ok[idx] * 1000000000ull / elapsed);
+}
+
+void sched_reset_stats(scheduler_t *s, uint64_t now_us)
+{
+    s->stats_start = now_us;
+    for (uint8_t i = 0; i < SENSOR_MAX; i++)
+    {
+        s->ok[i] = 0;
+        s->failed[i] = 0;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Escalonador de disparos de um conjunto de sensores. Só um sensor fica em
+// voo por vez, para que os ecos não se misturem; o próximo é disparado assim
+// que o anterior termina e passa o tempo de guarda, em vez de esperar uma
+// janela fixa do pior caso.
+typedef struct
+{
+    uint8_t count;
+    uint8_t next;
+    int8_t active;        // sensor em voo, -1 se nenhum
+    uint32_t interval_us; // intervalo mínimo entre disparos do mesmo sensor
+    uint32_t guard_us;    // silêncio entre o fim de um echo e o próximo trigger
+    uint64_t ready_at;    // fim do tempo de guarda corrente
+    uint32_t busy;        // sensores com o echo ainda alto, fora da fila
+    uint8_t shots;        // pings seguidos do mesmo sensor a cada disparo devido
+    int8_t group;         // sensor com pings do grupo pendentes, -1 se nenhum
+    uint8_t group_left;
+    uint64_t due[SENSOR_MAX];
+
+    // Contadores desde sched_reset_stats()
+    uint64_t stats_start;
+    uint32_t ok[SENSOR_MAX];
+    uint32_t failed[SENSOR_MAX];
+} scheduler_t;
+
+void sched_init(scheduler_t *s, uint8_t count, uint32_t interval_us, uint32_t guard_us);
+
+// Troca intervalo e guarda; todos os sensores ficam prontos para disparo. Com intervalo
+// zero cada sensor é redisparado assim que chega a sua vez (modo burst).
+void sched_set_timing(scheduler_t *s, uint32_t interval_us, uint32_t guard_us);
+
+// Oversampling: cada disparo devido vira um grupo de shots pings seguidos do
+// mesmo sensor, separados só pelo tempo de guarda. O intervalo conta do
+// primeiro ping do grupo.
+void sched_set_shots(scheduler_t *s, uint8_t shots);
+
+// Sensores que não podem ser disparados agora (bit i = sensor i): um trigger
+// com o echo ainda alto, preso ou de um pulso que passou do timeout, seria
+// ignorado pelo HC-SR04. Valem até a próxima chamada.
+static inline void sched_set_busy(scheduler_t *s, uint32_t mask)
+{
+    s->busy = mask;
+}
+
+// Retorna o sensor que deve ser disparado agora, ou -1. O sensor retornado
+// passa a ser o ativo até sched_done().
+int sched_next(scheduler_t *s, uint64_t now_us);
+
+// Registra o fim da medição do sensor ativo
+void sched_done(scheduler_t *s, uint8_t idx, bool ok, uint64_t now_us);
+
+// Leituras por segundo de um sensor, em milésimos de Hz
+uint32_t sched_rate_mhz(const scheduler_t *s, uint8_t idx, uint64_t now_us);
+
+void sched_reset_stats(scheduler_t *s, uint64_t now_us);
+
+#endif
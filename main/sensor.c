@@ -0,0 +1,214 @@
+#include "sensor.h"
+
+#include "hal.h"
+
+// Abre e fecha uma escrita dos campos protegidos pelo seqlock
+static void HAL_ISR_FUNC(write_begin)(sensor_state_t *s)
+{
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    // Nenhuma escrita dos campos sobe para antes do seq ímpar
+    atomic_thread_fence(memory_order_release);
+}
+
+static void HAL_ISR_FUNC(write_end)(sensor_state_t *s)
+{
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_release);
+}
+
+void sensor_init(sensor_state_t *s)
+{
+    s->alarm_id = 0;
+    s->window_us = 0;
+    for (int i = 0; i < SENSOR_REJ_COUNT; i++)
+        s->rejected[i] = 0;
+    atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+    s->ping = 0;
+    s->phase = SENSOR_IDLE;
+    s->t_trigger = 0;
+    s->t_subida = 0;
+    s->t_descida = 0;
+}
+
+uint32_t sensor_snapshot(const sensor_state_t *s, sensor_snapshot_t *out)
+{
+    uint32_t retries = 0;
+    for (;;)
+    {
+        uint32_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if ((seq & 1) == 0)
+        {
+            // Leituras voláteis: o compilador não pode reaproveitar valores
+            // de uma volta anterior
+            const volatile sensor_state_t *v = s;
+            out->ping = v->ping;
+            out->phase = v->phase;
+            out->t_trigger = v->t_trigger;
+            out->t_subida = v->t_subida;
+            out->t_descida = v->t_descida;
+
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&s->seq, memory_order_relaxed) == seq)
+                return retries;
+        }
+        retries++;
+    }
+}
+
+bool sensor_trigger(sensor_state_t *s, uint64_t now_us, uint32_t ping, uint32_t window_us)
+{
+    // Chamado fora de IRQ: a fase pode estar mudando
+    sensor_snapshot_t snap;
+    sensor_snapshot(s, &snap);
+    if (snap.phase != SENSOR_IDLE)
+        return false;
+
+    s->alarm_id = 0;
+    s->window_us = window_us;
+    write_begin(s);
+    s->ping = ping;
+    s->t_trigger = now_us;
+    s->t_subida = 0;
+    s->t_descida = 0;
+    s->phase = SENSOR_TRIGGERED;
+    write_end(s);
+    return true;
+}
+
+// Borda depois da janela do disparo em voo
+static bool HAL_ISR_FUNC(past_window)(const sensor_state_t *s, uint64_t now_us)
+{
+    return s->window_us > 0 && now_us - s->t_trigger > s->window_us;
+}
+
+static bool HAL_ISR_FUNC(reject)(sensor_state_t *s, sensor_reject_t reason)
+{
+    s->rejected[reason]++;
+    return false;
+}
+
+bool HAL_ISR_FUNC(sensor_on_rise)(sensor_state_t *s, uint64_t now_us)
+{
+    if (s->phase == SENSOR_ECHO_HIGH)
+        return reject(s, SENSOR_REJ_ORDER);
+    if (s->phase != SENSOR_TRIGGERED)
+        return reject(s, SENSOR_REJ_IDLE);
+    if (now_us < s->t_trigger + SENSOR_RISE_MIN_US)
+        return reject(s, SENSOR_REJ_EARLY);
+    if (past_window(s, now_us))
+        return reject(s, SENSOR_REJ_LATE);
+
+    write_begin(s);
+    s->t_subida = now_us;
+    s->phase = SENSOR_ECHO_HIGH;
+    write_end(s);
+    return true;
+}
+
+bool HAL_ISR_FUNC(sensor_on_fall)(sensor_state_t *s, uint64_t now_us)
+{
+    if (s->phase == SENSOR_TRIGGERED)
+        return reject(s, SENSOR_REJ_ORDER);
+    if (s->phase != SENSOR_ECHO_HIGH)
+        return reject(s, SENSOR_REJ_IDLE);
+    if (past_window(s, now_us))
+        return reject(s, SENSOR_REJ_LATE);
+
+    write_begin(s);
+    s->t_descida = now_us;
+    s->phase = SENSOR_DONE;
+    write_end(s);
+    return true;
+}
+
+bool HAL_ISR_FUNC(sensor_on_timeout)(sensor_state_t *s)
+{
+    if (s->phase != SENSOR_TRIGGERED && s->phase != SENSOR_ECHO_HIGH)
+        return false;
+
+    write_begin(s);
+    s->phase = SENSOR_TIMEOUT;
+    write_end(s);
+    return true;
+}
+
+bool HAL_ISR_FUNC(sensor_on_merged)(sensor_state_t *s)
+{
+    reject(s, SENSOR_REJ_MERGED);
+    return sensor_on_timeout(s);
+}
+
+bool HAL_ISR_FUNC(sensor_on_pulse)(sensor_state_t *s, uint64_t t_descida, uint32_t width_us)
+{
+    if (sensor_on_rise(s, t_descida - width_us) && sensor_on_fall(s, t_descida))
+        return true;
+
+    sensor_on_timeout(s);
+    return false;
+}
+
+bool sensor_take_result(sensor_state_t *s, sensor_result_t *out)
+{
+    sensor_snapshot_t snap;
+    sensor_snapshot(s, &snap);
+    if (snap.phase != SENSOR_DONE && snap.phase != SENSOR_TIMEOUT)
+        return false;
+
+    out->ok = (snap.phase == SENSOR_DONE);
+    out->ping = snap.ping;
+    out->t_trigger = snap.t_trigger;
+    out->t_subida = snap.t_subida;
+    out->t_descida = snap.t_descida;
+    out->pulse_us = out->ok ? (uint32_t)(out->t_descida - out->t_subida) : 0;
+
+    write_begin(s);
+    s->phase = SENSOR_IDLE;
+    write_end(s);
+    return true;
+}
+
+uint32_t sensor_echo_timeout_us(uint32_t range_mm)
+{
+    uint64_t round_trip_us = (uint64_t)range_mm * 2u * 1000000u / SENSOR_SOUND_SPEED_MM_S;
+    round_trip_us += round_trip_us * SENSOR_TIMEOUT_MARGIN_PCT / 100u;
+    return SENSOR_ECHO_LEAD_US + (uint32_t)round_trip_us;
+}
+
+const char *sensor_phase_name(sensor_phase_t phase)
+{
+    switch (phase)
+    {
+    case SENSOR_IDLE:
+        return "IDLE";
+    case SENSOR_TRIGGERED:
+        return "TRIGGERED";
+    case SENSOR_ECHO_HIGH:
+        return "ECHO_HIGH";
+    case SENSOR_DONE:
+        return "DONE";
+    case SENSOR_TIMEOUT:
+        return "TIMEOUT";
+    }
+    return "?";
+}
+
+const char *sensor_reject_name(sensor_reject_t reason)
+{
+    switch (reason)
+    {
+    case SENSOR_REJ_IDLE:
+        return "sem disparo";
+    case SENSOR_REJ_EARLY:
+        return "cedo";
+    case SENSOR_REJ_LATE:
+        return "tarde";
+    case SENSOR_REJ_ORDER:
+        return "fora de ordem";
+    case SENSOR_REJ_MERGED:
+        return "juntas";
+    case SENSOR_REJ_COUNT:
+        break;
+    }
+    return "?";
+}
@@ -0,0 +1,130 @@
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Velocidade do som usada para o cálculo do timeout (mm/s)
+#define SENSOR_SOUND_SPEED_MM_S 343000u
+
+// Folga entre o fim do trigger e a subida do echo (rajada de 40 kHz + atraso
+// interno do módulo)
+#define SENSOR_ECHO_LEAD_US 1000u
+
+// Menor atraso aceito entre o trigger e a subida do echo. O módulo só sobe
+// o echo depois de emitir a rajada de 8 ciclos de 40 kHz (200 us); uma
+// subida antes disso é ruído ou resto do disparo anterior.
+#ifndef SENSOR_RISE_MIN_US
+#define SENSOR_RISE_MIN_US 150u
+#endif
+
+// Margem sobre o tempo de ida e volta, em %, para cobrir ar mais frio
+#define SENSOR_TIMEOUT_MARGIN_PCT 10u
+
+// Fases de uma medição do HC-SR04
+typedef enum
+{
+    SENSOR_IDLE = 0,  // pronto para um novo trigger
+    SENSOR_TRIGGERED, // trigger enviado, aguardando subida do echo
+    SENSOR_ECHO_HIGH, // echo em nível alto, aguardando descida
+    SENSOR_DONE,      // pulso completo, resultado disponível
+    SENSOR_TIMEOUT,   // alarme estourou antes do fim do pulso
+} sensor_phase_t;
+
+// Motivos de rejeição de uma borda do echo
+typedef enum
+{
+    SENSOR_REJ_IDLE = 0, // nenhum disparo em voo (ocioso ou já concluído)
+    SENSOR_REJ_EARLY,    // subida antes de SENSOR_RISE_MIN_US do trigger
+    SENSOR_REJ_LATE,     // borda depois da janela do disparo
+    SENSOR_REJ_ORDER,    // descida sem subida, ou segunda subida
+    SENSOR_REJ_MERGED,   // subida e descida vistas juntas, sem os instantes
+    SENSOR_REJ_COUNT,
+} sensor_reject_t;
+
+// Estado de um sensor. Avançado pelos callbacks de IRQ (borda e alarme)
+// e consumido pelo loop principal com sensor_take_result().
+//
+// Os campos abaixo de seq são protegidos por um seqlock: quem escreve deixa
+// seq ímpar durante a escrita e par ao terminar, e quem lê copia tudo com
+// sensor_snapshot(), repetindo se seq mudou no meio. Assim o leitor nunca
+// vê um timestamp de 64 bits pela metade nem subida e descida de disparos
+// diferentes, e não precisa desligar as IRQs. Há um escritor por vez, pela
+// própria máquina de estados: o loop só escreve em IDLE (trigger) e em
+// DONE/TIMEOUT (take_result), fases em que as IRQs não escrevem.
+typedef struct
+{
+    int32_t alarm_id;
+    uint32_t window_us; // bordas aceitas até t_trigger + window_us (0 = sem limite)
+    uint32_t rejected[SENSOR_REJ_COUNT]; // bordas descartadas, por motivo
+
+    _Atomic uint32_t seq;
+    uint32_t ping; // id do disparo em voo (ou do último)
+    sensor_phase_t phase;
+    uint64_t t_trigger;
+    uint64_t t_subida;
+    uint64_t t_descida;
+} sensor_state_t;
+
+// Cópia consistente dos campos protegidos
+typedef struct
+{
+    uint32_t ping;
+    sensor_phase_t phase;
+    uint64_t t_trigger;
+    uint64_t t_subida;
+    uint64_t t_descida;
+} sensor_snapshot_t;
+
+// Resultado de uma medição concluída (tempos em us desde o boot)
+typedef struct
+{
+    bool ok;
+    uint32_t ping;
+    uint64_t t_trigger;
+    uint64_t t_subida;
+    uint64_t t_descida;
+    uint32_t pulse_us;
+} sensor_result_t;
+
+void sensor_init(sensor_state_t *s);
+
+// IDLE -> TRIGGERED. ping identifica o disparo nos registros; só bordas até
+// window_us depois do trigger pertencem a ele. Retorna false se ainda há uma
+// medição em andamento.
+bool sensor_trigger(sensor_state_t *s, uint64_t now_us, uint32_t ping, uint32_t window_us);
+
+// Eventos vindos das IRQs. Retornam true quando provocam transição; uma
+// borda que não pertence ao disparo em voo, ou fora de ordem, é contada em
+// rejected[] e ignorada.
+bool sensor_on_rise(sensor_state_t *s, uint64_t now_us);
+bool sensor_on_fall(sensor_state_t *s, uint64_t now_us);
+bool sensor_on_timeout(sensor_state_t *s);
+
+// As duas bordas do pulso chegaram na mesma IRQ e os instantes se
+// perderam: conta a rejeição e encerra o disparo em voo como timeout, em
+// vez de entregar um pulso de largura zero
+bool sensor_on_merged(sensor_state_t *s);
+
+// Pulso medido por inteiro fora da CPU (PIO), entregue com as duas bordas
+// de uma vez. Não há alarme de timeout nesse modo: um pulso rejeitado
+// encerra o disparo como timeout em vez de deixá-lo esperando outra borda.
+// Retorna true se o pulso foi aceito.
+bool sensor_on_pulse(sensor_state_t *s, uint64_t t_descida, uint32_t width_us);
+
+// Leitura sem trava de qualquer contexto. Retorna quantas vezes a cópia foi
+// refeita por uma escrita concorrente.
+uint32_t sensor_snapshot(const sensor_state_t *s, sensor_snapshot_t *out);
+
+// Se a medição terminou (DONE/TIMEOUT), copia o resultado, volta para IDLE
+// e retorna true. Nunca bloqueia.
+bool sensor_take_result(sensor_state_t *s, sensor_result_t *out);
+
+// Timeout de uma medição, contado do trigger, para alvos até range_mm
+uint32_t sensor_echo_timeout_us(uint32_t range_mm);
+
+const char *sensor_phase_name(sensor_phase_t phase);
+const char *sensor_reject_name(sensor_reject_t reason);
+
+#endif
@@ -0,0 +1,35 @@
+#include "sound.h"
+
+// k = c(T) * 16 / 125, com c(T) = 331,3 m/s * sqrt(1 + T / 273,15),
+// de -40 °C a +85 °C em passos de 5 °C
+static const uint16_t sound_k_table[] = {
+    39179, 39596, 40010, 40419, 40824, 41226, 41623, 42016, 42406,
+    42793, 43176, 43555, 43931, 44305, 44674, 45041, 45405, 45766,
+    46125, 46480, 46833, 47183, 47531, 47876, 48218, 48558,
+};
+
+#define SOUND_TABLE_LEN (sizeof(sound_k_table) / sizeof(sound_k_table[0]))
+
+_Static_assert(SOUND_TABLE_LEN == (SOUND_TEMP_MAX_DECI - SOUND_TEMP_MIN_DECI) / SOUND_TEMP_STEP_DECI + 1,
+               "tabela de velocidade do som não cobre a faixa");
+
+uint32_t sound_k_q8(int32_t temp_deci)
+{
+    if (temp_deci <= SOUND_TEMP_MIN_DECI)
+        return sound_k_table[0];
+    if (temp_deci >= SOUND_TEMP_MAX_DECI)
+        return sound_k_table[SOUND_TABLE_LEN - 1];
+
+    uint32_t offset = (uint32_t)(temp_deci - SOUND_TEMP_MIN_DECI);
+    uint32_t idx = offset / SOUND_TEMP_STEP_DECI;
+    uint32_t frac = offset % SOUND_TEMP_STEP_DECI;
+
+    uint32_t k0 = sound_k_table[idx];
+    uint32_t k1 = sound_k_table[idx + 1];
+    return k0 + ((k1 - k0) * frac + SOUND_TEMP_STEP_DECI / 2) / SOUND_TEMP_STEP_DECI;
+}
+
+uint32_t sound_speed_mm_s(uint32_t k_q8)
+{
+    return (k_q8 * 125u + 8u) / 16u;
+}
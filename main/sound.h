@@ -0,0 +1,23 @@
+#ifndef SOUND_H
+#define SOUND_H
+
+#include <stdint.h>
+
+// Velocidade do som em função da temperatura do ar, por tabela pré-calculada
+// com interpolação linear. O resultado é o fator k de distance_um(), então a
+// compensação não acrescenta nenhuma conta por amostra: k só é recalculado
+// quando a temperatura muda.
+
+// Faixa da tabela, em décimos de °C
+#define SOUND_TEMP_MIN_DECI (-400)
+#define SOUND_TEMP_MAX_DECI 850
+#define SOUND_TEMP_STEP_DECI 50
+
+// Fator k (Q8, ver distance.h) para uma temperatura em décimos de °C.
+// Temperaturas fora da faixa são saturadas.
+uint32_t sound_k_q8(int32_t temp_deci);
+
+// Velocidade do som em mm/s correspondente a um fator k
+uint32_t sound_speed_mm_s(uint32_t k_q8);
+
+#endif
@@ -0,0 +1,25 @@
+#include "temp_sensor.h"
+
+#include "hardware/adc.h"
+
+// Leituras somadas por medição, para reduzir o ruído do ADC
+#define TEMP_SENSOR_SAMPLES 8
+
+void temp_sensor_init(void)
+{
+    adc_init();
+    adc_set_temp_sensor_enabled(true);
+}
+
+int32_t temp_sensor_read_deci(void)
+{
+    adc_select_input(4);
+
+    uint32_t sum = 0;
+    for (int i = 0; i < TEMP_SENSOR_SAMPLES; i++)
+        sum += adc_read();
+
+    // Vref de 3,3 V e 12 bits; T = 27 - (V - 0,706) / 0,001721 (datasheet)
+    int32_t v_uv = (int32_t)(((uint64_t)sum * 3300000u / TEMP_SENSOR_SAMPLES) >> 12);
+    return 270 - (v_uv - 706000) * 10 / 1721;
+}
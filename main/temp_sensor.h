@@ -0,0 +1,14 @@
+#ifndef TEMP_SENSOR_H
+#define TEMP_SENSOR_H
+
+#include <stdint.h>
+
+// Sensor de temperatura interno do RP2040 (entrada 4 do ADC). Mede a
+// temperatura do chip, que acompanha a do ar com placa em repouso.
+
+void temp_sensor_init(void);
+
+// Temperatura em décimos de °C
+int32_t temp_sensor_read_deci(void);
+
+#endif
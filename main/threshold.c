@@ -0,0 +1,136 @@
+#include "threshold.h"
+
+#include <string.h>
+
+#include "hal.h"
+
+void threshold_init(threshold_t *t)
+{
+    atomic_store_explicit(&t->limits_mm, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->release_timeouts, THRESHOLD_RELEASE_TIMEOUTS, memory_order_relaxed);
+    t->near_mask = 0;
+    memset(t->timeouts, 0, sizeof(t->timeouts));
+    atomic_store_explicit(&t->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->drops, 0, memory_order_relaxed);
+    threshold_reset_stats(t);
+}
+
+bool threshold_set(threshold_t *t, uint32_t near_mm, uint32_t far_mm, uint32_t release_timeouts)
+{
+    if (near_mm > 0 && (far_mm <= near_mm || far_mm > UINT16_MAX))
+        return false;
+    if (release_timeouts < 1 || release_timeouts > UINT8_MAX)
+        return false;
+    if (near_mm == 0)
+        far_mm = 0;
+
+    atomic_store_explicit(&t->release_timeouts, release_timeouts, memory_order_relaxed);
+    atomic_store_explicit(&t->limits_mm, near_mm | far_mm << 16, memory_order_relaxed);
+    return true;
+}
+
+static void HAL_ISR_FUNC(push_event)(threshold_t *t, const threshold_event_t *e)
+{
+    uint32_t head = atomic_load_explicit(&t->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&t->tail, memory_order_acquire);
+    if (head - tail >= THRESHOLD_EVENTS)
+    {
+        atomic_store_explicit(&t->drops, atomic_load_explicit(&t->drops, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    t->ev[head & (THRESHOLD_EVENTS - 1)] = *e;
+    atomic_store_explicit(&t->head, head + 1, memory_order_release);
+}
+
+void HAL_ISR_FUNC(threshold_eval)(threshold_t *t, uint8_t sensor, uint32_t distance_um,
+                                  uint64_t t_trigger_us, uint64_t t_edge_us)
+{
+    // Uma leitura só: perto e longe do mesmo threshold_set()
+    uint32_t limits = atomic_load_explicit(&t->limits_mm, memory_order_relaxed);
+    uint32_t near_um = (limits & 0xffff) * 1000;
+    uint32_t far_um = (limits >> 16) * 1000;
+    if (near_um == 0 && t->near_mask == 0)
+        return;
+
+    uint32_t bit = 1u << sensor;
+    bool was_near = (t->near_mask & bit) != 0;
+    bool near = was_near;
+    if (near_um == 0)
+        near = false;
+    else if (distance_um == THRESHOLD_NO_ECHO)
+    {
+        // Sem echo o estado fica; só timeouts seguidos soltam o sensor
+        if (was_near && ++t->timeouts[sensor] >= atomic_load_explicit(&t->release_timeouts, memory_order_relaxed))
+            near = false;
+    }
+    else
+    {
+        t->timeouts[sensor] = 0;
+        if (distance_um < near_um)
+            near = true;
+        else if (distance_um > far_um)
+            near = false;
+    }
+
+    if (near != was_near)
+    {
+        t->timeouts[sensor] = 0;
+        bool out_before = t->near_mask != 0;
+        t->near_mask = near ? t->near_mask | bit : t->near_mask & ~bit;
+        if ((t->near_mask != 0) != out_before)
+            hal_gpio_put(THRESHOLD_OUT_PIN, t->near_mask != 0);
+    }
+
+    // Latência de toda avaliação: é o tempo que o pino levaria para mudar
+    uint64_t now = hal_time_us();
+    uint32_t edge = (uint32_t)(now - t_edge_us);
+    uint32_t trig = (uint32_t)(now - t_trigger_us);
+
+    threshold_stats_t *s = &t->stats;
+    if (s->count == 0 || edge < s->edge_min)
+        s->edge_min = edge;
+    if (edge > s->edge_max)
+        s->edge_max = edge;
+    if (trig > s->trig_max)
+        s->trig_max = trig;
+    s->edge_sum += edge;
+    s->trig_sum += trig;
+    s->count++;
+
+    if (near == was_near)
+        return;
+
+    threshold_event_t e = {
+        .t_us = t_edge_us,
+        .distance_um = distance_um,
+        .latency_us = edge > UINT16_MAX ? UINT16_MAX : (uint16_t)edge,
+        .sensor = sensor,
+        .near = near,
+    };
+    push_event(t, &e);
+}
+
+bool threshold_pop(threshold_t *t, threshold_event_t *out)
+{
+    uint32_t tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&t->head, memory_order_acquire);
+    if (head == tail)
+        return false;
+
+    *out = t->ev[tail & (THRESHOLD_EVENTS - 1)];
+    atomic_store_explicit(&t->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+void threshold_reset_stats(threshold_t *t)
+{
+    threshold_stats_t *s = &t->stats;
+    s->count = 0;
+    s->edge_min = 0;
+    s->edge_max = 0;
+    s->edge_sum = 0;
+    s->trig_max = 0;
+    s->trig_sum = 0;
+}
@@ -0,0 +1,121 @@
+#ifndef THRESHOLD_H
+#define THRESHOLD_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Modo intertravamento: limiares perto/longe com histerese, avaliados na
+// própria IRQ da descida do echo (ou do timeout), sem passar pelo core0 nem
+// pela serial. Um sensor entra em "perto" abaixo do limiar perto e só sai
+// acima do longe. O pino de saída fica ativo enquanto algum sensor está perto.
+// Cada transição vira um evento num anel lido pelo core0.
+//
+// Timeout não é prova de que o alvo saiu (um ping perdido com o objeto
+// ainda perto soltaria o pino): mantém o estado, e um sensor em "perto" só
+// é solto depois de release_timeouts timeouts seguidos.
+
+// Pino de saída do intertravamento, ativo em nível alto
+#ifndef THRESHOLD_OUT_PIN
+#define THRESHOLD_OUT_PIN 18
+#endif
+
+// Timeouts seguidos que soltam um sensor em "perto", se o comando não
+// disser outro valor
+#ifndef THRESHOLD_RELEASE_TIMEOUTS
+#define THRESHOLD_RELEASE_TIMEOUTS 3
+#endif
+
+// Capacidade do anel de eventos (potência de 2)
+#ifndef THRESHOLD_EVENTS
+#define THRESHOLD_EVENTS 16
+#endif
+
+#if (THRESHOLD_EVENTS & (THRESHOLD_EVENTS - 1)) != 0
+#error "THRESHOLD_EVENTS deve ser potência de 2"
+#endif
+
+// Distância informada para um timeout
+#define THRESHOLD_NO_ECHO UINT32_MAX
+
+typedef struct
+{
+    uint64_t t_us;        // instante da borda (ou do timeout) que decidiu
+    uint32_t distance_um; // THRESHOLD_NO_ECHO se timeout
+    uint16_t latency_us;  // da borda ao pino atualizado
+    uint8_t sensor;
+    uint8_t near;
+} threshold_event_t;
+
+// Latências de todas as avaliações, em us: da borda do echo ao pino (tempo
+// de decisão na IRQ) e do trigger ao pino (inclui o voo do som)
+typedef struct
+{
+    uint32_t count;
+    uint32_t edge_min;
+    uint32_t edge_max;
+    uint64_t edge_sum;
+    uint32_t trig_max;
+    uint64_t trig_sum;
+} threshold_stats_t;
+
+typedef struct
+{
+    // Perto e longe em mm, num só word (perto nos 16 bits baixos): o core0
+    // troca os dois de uma vez e a IRQ do core1 nunca vê um par misturado.
+    // Perto = 0 desliga.
+    _Atomic uint32_t limits_mm;
+    _Atomic uint32_t release_timeouts;
+    uint32_t near_mask; // sensores em "perto"
+    // Timeouts seguidos de cada sensor em "perto"
+    uint8_t timeouts[SENSOR_MAX];
+
+    threshold_stats_t stats;
+
+    // Anel de um produtor (IRQs do core1) e um consumidor (core0)
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t drops;
+    threshold_event_t ev[THRESHOLD_EVENTS];
+} threshold_t;
+
+void threshold_init(threshold_t *t);
+
+// Limiares com histerese: exige near_mm < far_mm <= UINT16_MAX e
+// 1 <= release_timeouts <= UINT8_MAX. near_mm = 0 desliga e solta o pino
+// na próxima avaliação.
+bool threshold_set(threshold_t *t, uint32_t near_mm, uint32_t far_mm, uint32_t release_timeouts);
+
+static inline uint32_t threshold_near_mm(threshold_t *t)
+{
+    return atomic_load_explicit(&t->limits_mm, memory_order_relaxed) & 0xffff;
+}
+
+static inline uint32_t threshold_far_mm(threshold_t *t)
+{
+    return atomic_load_explicit(&t->limits_mm, memory_order_relaxed) >> 16;
+}
+
+static inline uint32_t threshold_release_timeouts(threshold_t *t)
+{
+    return atomic_load_explicit(&t->release_timeouts, memory_order_relaxed);
+}
+
+static inline bool threshold_enabled(threshold_t *t)
+{
+    return threshold_near_mm(t) > 0;
+}
+
+// Chamado na IRQ com o resultado de uma medição. t_edge_us é o instante da
+// borda (ou do timeout), t_trigger_us o do trigger.
+void threshold_eval(threshold_t *t, uint8_t sensor, uint32_t distance_um, uint64_t t_trigger_us,
+                    uint64_t t_edge_us);
+
+// Consumidor (core0). Retorna false se não há eventos.
+bool threshold_pop(threshold_t *t, threshold_event_t *out);
+
+void threshold_reset_stats(threshold_t *t);
+
+#endif